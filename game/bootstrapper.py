@@ -31,6 +31,26 @@ def cast(cast_type, value):
     return cast_method()
 
 
+""" Compiled level scripts, mapping each filename to its modification time and code object.
+The bootstrapper module is kept between runs, so restarting a level script or coming back to a level doesn't read or compile it again.
+"""
+compiled_scripts = {}
+
+def compile_script(script_filename):
+    """ Returns the compiled code of a level script, from compiled_scripts if the file hasn't changed since it was compiled. """
+    modification_time = os.path.getmtime(script_filename)
+    if script_filename in compiled_scripts:
+        compiled_time, compiled_code = compiled_scripts[script_filename]
+        if compiled_time == modification_time:
+            return compiled_code
+
+    with open(script_filename, encoding="utf8") as script_file:
+        script = script_file.read()
+    compiled_code = compile(script, script_filename, "exec")
+    compiled_scripts[script_filename] = (modification_time, compiled_code)
+    return compiled_code
+
+
 """ Returns a class called ScopedIntepreter, which is actually a child of code.InteractiveInterpreter,
 this class is used to interpret and run python level code, while inserting objects who have inherited from
 their parents.
@@ -97,6 +117,7 @@ def start(entities, cpp_engine, RESTART, STOP, KILL, waiting):
             time.sleep(0.05)
 
         engine = Engine(cpp_engine)	#wrap the cpp engine in the python engine wrapper
+        engine.cancel_coroutines() #stop any coroutines left from the last time the level script was run
         """
         Run the main bootstrapper loop! It's fun!
         """
@@ -120,26 +141,32 @@ def start(entities, cpp_engine, RESTART, STOP, KILL, waiting):
             try:
                 script_filename = os.path.dirname(os.path.realpath(__file__)) + "/levels/{}/script.py".format(engine.get_level_location()); #TODO: grab this stuff form the config
                 engine.print_debug("Reading from file: {}".format(script_filename))
-                with open(script_filename, encoding="utf8") as script_file:
-                    script = script_file.read()
-                    #engine.print_debug(script)
+                script = compile_script(script_filename)
+
+                def run_limited():
+                    """ Runs the level script with a budget, so it lets the game take the GIL and can be halted hard from here down when the level is closed """
+                    cpp_engine.limit_level_thread(KILL)
+                    scoped_interpreter.runcode(script)
 
-                scoped_interpreter.runcode(script)
+                run_limited()
 
             except RESTART:
                 engine.print_debug("restarting")
+                engine.cancel_coroutines()
 
                 waiting = False
                 continue
 
             except STOP:
                 engine.print_debug("STOPPING")
+                engine.cancel_coroutines()
                 #entity.update_status("stopped")
                 waiting = True
                 continue
 
             except KILL:
                 engine.print_debug("KILLED")
+                engine.cancel_coroutines()
                 # Printing from Python when the game is dead hangs
                 # everything, so don't do it.
                 # TODO (Joshua): Fix this problem
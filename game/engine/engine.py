@@ -3,8 +3,10 @@ import sys
 import importlib
 import sqlite3
 import json
-import threading
 import collections
+import contextlib
+
+from scheduler import Scheduler, make_awaitable
 
 class Engine:
     """ This class is a python wrapper for all the engine features that are exposed to the game.
@@ -17,17 +19,25 @@ class Engine:
     __game_objects_by_id = dict()
     #A dictionary of all the game objects in the level (maps from object_name to object)
     __game_objects_by_name = dict()
-    #Represents the connections to the sqlite database
-    conn = dict()
-
     #Whether the most recent script run gave an error
     __error = False
 
-    __json_data = None
+    #The dialogue table column for each language
+    __language_columns = {
+        "english": "english",
+        "français": "french",
+        "french": "french",
+        "nederlands": "dutch",
+        "dutch": "dutch",
+        "hindi": "hindi",
+        "pyrate": "pyrate"
+    }
 
     def get_dialogue(self, level_name, identifier, escapes = dict()):
         """ Get the piece of dialoge requested form the database.
 
+        The dialogue is looked up in a table the C++ engine keeps of all the dialogue in the current language, see load_dialogue.
+
         Parameters
         ----------
         level_name : str
@@ -42,29 +52,19 @@ class Engine:
         str
             Returns the specific dialogue requested from the database
         """
+        if self.__cpp_engine.get_dialogue_language() != self.language:
+            self.load_dialogue()
+        return self.__cpp_engine.get_dialogue(level_name, identifier, escapes) #TODO: Make it so that game complains much more about invalid identifiers in debug mode!!!!
+
+    def load_dialogue(self):
+        """ Loads all the dialogue in the current language from the database into the C++ engine's dialogue table.
 
-        if not(threading.current_thread() in self.conn):
-            self.conn[threading.current_thread()] = sqlite3.connect(self.dblocation)
-        result = self.conn[threading.current_thread()].execute("SELECT english, french, dutch, hindi, pyrate FROM dialogue WHERE level=? AND identifier=?;", (level_name, identifier))
-
-        row = result.fetchone()
-        dialogue = "invalid dialogue identifier" #TODO: Make it so that game complains much more about this in debug mode!!!!
-        if(row != None):
-            english, french, dutch, hindi, pyrate = row
-            if(self.language == "english"):
-                dialogue = english
-            if(self.language == "french"):
-                dialogue = français
-            if(self.language == "dutch"):
-                dialogue = nederlands
-            if(self.language == "hindi"):
-                dialogue = hindi
-            if(self.language == "pyrate"):
-                dialogue = pyrate
-
-        for escape in escapes:
-            dialogue = dialogue.replace("%" + escape + "%", escapes[escape])
-        return dialogue
+        The table is kept between levels, so this only needs to query the database when the game starts or the language changes.
+        """
+        with contextlib.closing(sqlite3.connect(self.dblocation)) as conn:
+            column = self.__language_columns.get(self.language, "english")
+            rows = conn.execute("SELECT level, identifier, " + column + " FROM dialogue;").fetchall()
+        self.__cpp_engine.load_dialogue(self.language, rows)
 
     def __init__(self, cpp_engine):
         """ On initialisation, the cplusplus engine is passed to this class to enable it to access the api of the game.
@@ -76,6 +76,7 @@ class Engine:
         """
 
         self.__cpp_engine = cpp_engine
+        self.__scheduler = Scheduler(self, cpp_engine)
         self.__game_objects_by_id.clear() #Have to do this otherwise the engine seems to still have the objects of the last engine instance
         self.__game_objects_by_name.clear() #Have to do this otherwise the engine seems to still have the objects of the last engine instance
         #Use some magic trickery to give the Engine class all the methods of the C++GameEngine with their functionality
@@ -89,15 +90,8 @@ class Engine:
         self.all_languages = ["english", "français", "nederlands", "hindi", "pyrate"]
         self.dblocation = os.path.dirname(os.path.realpath(__file__)) + "/../database.db"
         self.language = self.get_config()['game_settings']['language']
-        self.conn[threading.current_thread()] = sqlite3.connect(self.dblocation)
-
-    def __del__(self):
-        """ Destructor for the game engine.
-
-        On termination all links to the database are closed
-        """
-        for key in self.conn:
-            self.conn[key].close()
+        if self.__cpp_engine.get_dialogue_language() != self.language:
+            self.load_dialogue()
 
     def set_language(self, language_to_set):
         """ Sets the language of the game. (English, French, Dutch, Hindi, Pyrate)
@@ -111,6 +105,7 @@ class Engine:
 
         if(language_to_set in self.all_languages):
             self.language = language_to_set
+            self.load_dialogue()
         else:
             print("Not a valid language!")
 
@@ -183,6 +178,47 @@ class Engine:
         x, y = position                                     #Extract the position x and y coordinates
         return self.__cpp_engine.is_solid(x, y)
 
+    def find_path(self, start, goal):
+        """ Find a shortest path from one position to another which goes around anything solid.
+
+        The start and goal may be solid themselves, so you can find a path from a character to another character.
+
+        Parameters
+        ----------
+        start: 2-tuple of int
+            The position to start from. (x,y)
+        goal: 2-tuple of int
+            The position to get to. (x,y)
+
+        Returns
+        -------
+        list of 2-tuple of int
+            The steps to take, one tile each, which can be passed straight to move_path. Empty if the goal can't be reached.
+        """
+        start_x, start_y = start
+        goal_x, goal_y = goal
+        return self.__cpp_engine.find_path(start_x, start_y, goal_x, goal_y)
+
+    def get_flow_direction(self, position, targets):
+        """ Find which way to step to get closer to the nearest of some targets, going around anything solid.
+
+        Asking again after every step is cheap, as the search from the targets is shared until something moves.
+
+        Parameters
+        ----------
+        position: 2-tuple of int
+            The position to step from. (x,y)
+        targets: list of 2-tuple of int
+            The positions to head for.
+
+        Returns
+        -------
+        2-tuple of int
+            The step to take, such as (1, 0) for east, or (0, 0) if the position is a target or none can be reached.
+        """
+        x, y = position
+        return self.__cpp_engine.get_flow_direction(x, y, list(targets))
+
     def print_terminal(self, message, highlighted = False, callback = lambda: None):
         """ print the given message to in-game terminal
 
@@ -283,34 +319,30 @@ class Engine:
         result = self.__cpp_engine.get_config()
         return json.loads(result)
 
-    def __get_json_data(self, force_reread = False):
-        """
+    def __get_save_data(self, section, key = ""):
+        """ Returns a value from the save game, which the C++ engine keeps in memory
+
+        Parameters
+        ----------
+        section : str
+            The top-level key in save.json, such as "settings" or "player_saves"
+        key : str, optional
+            The key within the section, or the whole section if not given
+
         Returns
         -------
         python json object
-            A json object that contains the data of the player. (Last checkpoint, worlds unlocked, etc.)
+            The value, or None if there isn't one
         """
-        if (not self.__json_data) or force_reread:
-            settings_string = ""
-            with open(self.get_config()['files']['game_save_location'], encoding="utf8") as save_file:
-                settings_string = save_file.read()
-            self.__json_data= json.loads(settings_string)
-        return self.__json_data
+        return json.loads(self.__cpp_engine.get_save_data(section, key))
 
-    def __save_json_data(self):
-        """ Updates the json save file with the current state of the player """
+    def __has_save_data(self, section, key = ""):
+        """ Returns whether the save game has a value, without fetching it """
+        return self.__cpp_engine.has_save_data(section, key)
 
-        save_file_string = ""
-        with open(self.get_config()['files']['game_save_location'], encoding="utf8") as save_file:
-            save_file_string = save_file.read()
-
-        save_json = json.loads(save_file_string)
-        save_json = self.__json_data
-
-        with open(self.get_config()['files']['game_save_location'], 'w', encoding="utf8") as save_file:
-            json.dump(save_json, save_file, indent=4, separators=(',', ': '))
-        self.refresh_config()
-        return
+    def __set_save_data(self, section, key, value):
+        """ Changes a value in the save game. The C++ engine writes it to save.json in the background, so this doesn't wait for the disk """
+        self.__cpp_engine.set_save_data(section, key, json.dumps(value))
 
     def get_settings(self):
         """ Return the settings from the save.json file as a python json object
@@ -320,7 +352,7 @@ class Engine:
         python json object
             The current settings of the game as a json object.
         """
-        return self.__get_json_data()["settings"]
+        return self.__get_save_data("settings")
 
     def save_settings(self, settings):
         """ Saves the game settings with the current settings
@@ -332,8 +364,10 @@ class Engine:
         """ #TODO: add resiliency!!!!
 
 
-        self.__json_data["settings"] = settings
-        self.__save_json_data()
+        self.__set_save_data("settings", "", settings)
+        #The config reads the settings from save.json, so it has to be written before the config is refreshed
+        self.flush_save()
+        self.refresh_config()
         return
 
     def get_player_data(self, name):
@@ -350,12 +384,10 @@ class Engine:
 
 
         """
-        if name in self.__get_json_data()["player_saves"]:
-            return self.__get_json_data()["player_saves"][name]
-        elif name in self.__get_json_data(force_reread = True)["player_saves"]:
-            return self.__get_json_data()["player_saves"][name]
-        else:
+        player_data = self.__get_save_data("player_saves", name)
+        if player_data is None:
             return {}
+        return player_data
 
     def save_player_data(self, name, game_save):
         """ Saves the player's save state in the json save file
@@ -369,8 +401,7 @@ class Engine:
 
         """
         #TODO: add resiliency!!!!
-        self.__json_data["player_saves"][name] = game_save
-        self.__save_json_data()
+        self.__set_save_data("player_saves", name, game_save)
         return
 
     def save_exists(self, name):
@@ -383,11 +414,7 @@ class Engine:
         name : str
             The string of the name that we want to check for existence in the save.json file.
         """
-        save_data = self.__get_json_data()
-        if name in save_data["player_saves"]:
-            return True
-        else:
-            return False
+        return self.__has_save_data("player_saves", name)
 
     def set_ui_colours(self, colour_one, colour_two):
         """ Sets the user interface to a color scheme indicated by colour_one and colour_two.
@@ -443,13 +470,16 @@ class Engine:
         #Grabs the object's location in the file system (original data comes from the map's tmx file, eg. characters/enemies/crocodile
         entity_location = entity.get_location()
         #Imports the correct module based on that path name
-        sys.path.insert(1, os.path.dirname(os.path.realpath(__file__)) + "/../objects/" + entity_location)  # Go to the correct folder
+        object_folder = os.path.dirname(os.path.realpath(__file__)) + "/../objects/" + entity_location
+        if object_folder not in sys.path:  # Objects are wrapped every time a level starts, so don't let sys.path keep growing
+            sys.path.insert(1, object_folder)  # Go to the correct folder
         # Then get the name of the file itself (same name as the folder it's in, so can be extracted from the path name, eg crocodile/crocodile.py)
         module_name = entity_location[entity_location.rfind("/") + 1: ]
         module = importlib.import_module(module_name) # Import the module as module
 
         #Get the class from the module, will be the same as it's file but in UpperCamelCase eg. SuperCrocodile in super_crocodile.py
         wrapper_class = getattr(module, self.__snake_to_camelcase(module_name))
+        make_awaitable(wrapper_class)  # let level scripts await the object's actions
         game_object = wrapper_class()  # create the object
         game_object.set_entity(entity, self)  # initialise it and wrap the entity instance in it
         self.__game_objects_by_id[game_object.get_id()] = game_object # associate each game_object with its id
@@ -474,6 +504,24 @@ class Engine:
         """
         self.__cpp_engine.show_dialogue(dialogue, ignore_scripting, callback)
 
+    def show_conversation(self, dialogues, ignore_scripting = False, callback = lambda: None):
+        """ The engine displays each piece of dialogue in turn, as if show_dialogue had been called for each one after the last had closed.
+
+        Handing over the whole conversation lets the engine render the later pages while the player is reading the earlier ones,
+        so that moving on to the next page is instant.
+
+        Parameters
+        ----------
+        dialogues : list of str
+            The strings that will be displayed on the dialogue window, in order
+        ignore_scripting : bool, optional
+            As for show_dialogue
+        callback : func, optional
+            Places the callback onto the engine once the last piece of dialogue has been closed
+        """
+        self.__cpp_engine.prerender_dialogue(list(dialogues))
+        self.run_callback_list_sequence([lambda callback, dialogue = dialogue: self.show_dialogue(dialogue, ignore_scripting, callback) for dialogue in dialogues], callback)
+
     def close_external_script_help(self, callback = lambda: None):
         """ This closes the dialogue box created by show_external_script_help
 
@@ -507,6 +555,25 @@ class Engine:
         """
         self.__cpp_engine.show_dialogue_with_options(dialogue, disable_scripting, options)
 
+    def run_async(self, coroutine, callback = lambda: None):
+        """ Run a coroutine on the engine's event loop, so that a level script can wait for actions with await instead of chaining callbacks.
+
+        Any method which takes a callback can be awaited, for example "await player.move_east()". Coroutines run one at a time, and carry on
+        from where they were waiting once the action they awaited finishes.
+
+        Parameters
+        ----------
+        coroutine : coroutine
+            Made by calling an async def function, e.g. engine.run_async(intro())
+        callback : func, optional
+            Places the callback onto the engine event-queue once the coroutine has returned
+        """
+        self.__scheduler.run(coroutine, callback)
+
+    def cancel_coroutines(self):
+        """ Stop every coroutine started with run_async, used when the level script is stopped or restarted. """
+        self.__scheduler.cancel_all()
+
     def run_callback_list_sequence(self, callback_list_sequence, callback = lambda: None):
         """ Run the given list of functions, passing the rest of the list as an argument to the first function so that they are run in sequence.
 
@@ -782,4 +849,4 @@ class Engine:
         #self.__cpp_engine.update_totems_text(totems_achieved, totems_total)
         self.__cpp_engine.update_totems_text(totems_achieved, True)
 
-
+make_awaitable(Engine)
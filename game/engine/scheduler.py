@@ -0,0 +1,196 @@
+import functools
+import inspect
+import threading
+import traceback
+
+class Action:
+    """ Represents an engine action which has been started, such as a character moving.
+
+    Every method which takes a callback returns one of these, so instead of passing a callback a level script can wait for the action to finish
+    from inside a coroutine with await, for example:
+
+        async def intro():
+            await monkey.wait(3)
+            await monkey.move_east()
+            await engine.show_dialogue("The monkey got away!")
+
+        engine.run_async(intro())
+    """
+
+    def __init__(self):
+        self.__lock = threading.Lock()
+        self.__finished = False
+        self.__waiters = []
+
+    def is_finished(self):
+        """ Returns whether the action has finished """
+        return self.__finished
+
+    def finish(self):
+        """ Marks the action as finished and runs everything that was waiting for it """
+        with self.__lock:
+            self.__finished = True
+            waiters = self.__waiters
+            self.__waiters = []
+
+        for waiter in waiters:
+            waiter()
+
+    def when_finished(self, waiter):
+        """ Runs waiter once the action has finished, straight away if it already has
+
+        Parameters
+        ----------
+        waiter : func
+            Called with no arguments, on whichever thread finishes the action
+        """
+        with self.__lock:
+            if not self.__finished:
+                self.__waiters.append(waiter)
+                return
+
+        waiter()
+
+    def __await__(self):
+        if not self.__finished:
+            yield self
+
+def awaitable(method):
+    """ Wraps a method which takes a callback so that it returns an Action which finishes once the callback has been run.
+
+    The method still starts straight away and still runs its callback, so existing callers are unaffected.
+    Methods which return something of their own still return it, and methods without a callback parameter are returned unchanged.
+    """
+    parameters = inspect.signature(method).parameters
+    if "callback" not in parameters:
+        return method
+
+    #Work out where the callback is passed once, rather than binding the arguments on every call, as entity movement goes through here
+    if parameters["callback"].kind == inspect.Parameter.POSITIONAL_OR_KEYWORD:
+        position = list(parameters).index("callback")
+    else:
+        position = None
+
+    @functools.wraps(method)
+    def wrapper(*args, **kwargs):
+        action = Action()
+        passed_positionally = position is not None and len(args) > position
+        if passed_positionally:
+            original_callback = args[position]
+        else:
+            original_callback = kwargs.get("callback", lambda: None)
+
+        def callback():
+            try:
+                original_callback()
+            finally:
+                action.finish()
+
+        if passed_positionally:
+            args = args[:position] + (callback,) + args[position + 1:]
+        else:
+            kwargs["callback"] = callback
+        result = method(*args, **kwargs)
+        if result is not None:
+            return result
+        return action
+
+    wrapper.is_awaitable = True
+    return wrapper
+
+def make_awaitable(cls):
+    """ Makes every public method which takes a callback, on a class and its parents, return an Action (see awaitable)
+
+    Safe to call more than once on the same class.
+    """
+    for klass in cls.__mro__:
+        if klass is object or "_awaitable_actions" in klass.__dict__:
+            continue
+        for name, member in list(klass.__dict__.items()):
+            if not name.startswith("_") and inspect.isfunction(member):
+                wrapped = awaitable(member)
+                if wrapped is not member:
+                    setattr(klass, name, wrapped)
+        klass._awaitable_actions = True
+    return cls
+
+class CoroutineTimeoutException(Exception):
+    """ Raised in a coroutine which has run for too long without awaiting (see "coroutine_step_budget" in config.jsonnet) """
+    pass
+
+class _Task:
+    """ A coroutine being run by a Scheduler """
+    def __init__(self, coroutine, callback):
+        self.coroutine = coroutine
+        self.callback = callback
+
+class Scheduler:
+    """ Runs level script coroutines on the engine's event loop.
+
+    Each coroutine is run until it awaits an Action, and carries on from the event queue once that action finishes.
+    All the coroutines share the engine's thread and take turns in the order their actions finish, instead of needing a thread each.
+
+    As they run on the engine's thread, the game is frozen while a coroutine runs between awaits, and stopping or restarting the level
+    script can't interrupt it. So each step is given a processor time budget, and a coroutine which uses it up, say by looping without
+    awaiting, is stopped with a CoroutineTimeoutException. Time spent blocked outside Python, such as in time.sleep, isn't caught.
+    """
+
+    #The coroutines which are running. Shared by every scheduler, as the bootstrapper makes a new engine each time the level script is restarted
+    __tasks = set()
+
+    def __init__(self, engine, cpp_engine):
+        self.__engine = engine
+        self.__cpp_engine = cpp_engine
+
+    def run(self, coroutine, callback = lambda: None):
+        """ Start running a coroutine from the event queue
+
+        Parameters
+        ----------
+        coroutine : coroutine
+            Made by calling an async def function
+        callback : func, optional
+            Placed onto the engine event-queue once the coroutine has returned
+        """
+        task = _Task(coroutine, callback)
+        self.__tasks.add(task)
+        self.__engine.add_event(lambda: self.__step(task))
+
+    def cancel_all(self):
+        """ Stop every coroutine the next time it would carry on, without running their callbacks """
+        self.__tasks.clear()
+
+    def __step(self, task):
+        """ Run a coroutine up to the next action it waits for """
+        if task not in self.__tasks:
+            task.coroutine.close()
+            return
+
+        try:
+            #Called straight from here, so only the coroutine is stopped when it runs out of time, not this step
+            self.__cpp_engine.limit_coroutine_step(CoroutineTimeoutException)
+            try:
+                awaited = task.coroutine.send(None)
+            finally:
+                self.__cpp_engine.unlimit_coroutine_step()
+        except StopIteration:
+            self.__tasks.discard(task)
+            self.__engine.add_event(task.callback)
+            return
+        except CoroutineTimeoutException:
+            self.__tasks.discard(task)
+            task.coroutine.close()
+            self.__engine.print_terminal("A level script coroutine ran for too long without awaiting anything, so it was stopped", True)
+            return
+        except Exception:
+            self.__tasks.discard(task)
+            self.__engine.print_terminal(traceback.format_exc(), True)
+            return
+
+        if not isinstance(awaited, Action):
+            self.__tasks.discard(task)
+            task.coroutine.close()
+            self.__engine.print_terminal("Level scripts can only await engine actions, not {}".format(awaited), True)
+            return
+
+        awaited.when_finished(lambda: self.__engine.add_event(lambda: self.__step(task)))
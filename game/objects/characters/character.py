@@ -542,6 +542,51 @@ class Character(GameObject, ScriptStateContainer):
         self.__move_x(self.face_west, super().move_west, callback)
         return
 
+    def move_path(self, path, callback = lambda: None):
+        """ Moves the character along a path, facing the way they walk and animating them.
+
+        Each straight run of the path is walked by the engine in one go, so Python is only woken when the character turns.
+        Stops early if a step is blocked.
+
+        Overides general object implementation
+
+        Parameters
+        ----------
+        path : list of 2 tuple of int
+            The steps to take, relative to the previous position, e.g. [(1, 0), (0, 1)] for east then north
+        callback : func, optional
+            Places the callback onto the engine event-queue once the path is finished or blocked
+        """
+        path = list(path)
+        if not path:
+            self.get_engine().add_event(callback)
+            return
+
+        # Split off the steps in the same direction as the first one.
+        step = path[0]
+        run_length = 1
+        while run_length < len(path) and path[run_length] == step:
+            run_length += 1
+        run, rest = path[:run_length], path[run_length:]
+
+        x, y = self.get_position()
+        expected = (x + step[0] * run_length, y + step[1] * run_length)
+
+        def continue_path():
+            if rest and self.get_position() == expected:
+                self.move_path(rest, callback)
+            else:
+                self.__stop_animating_func(callback)
+
+        dx, dy = step
+        if abs(dx) >= abs(dy):
+            self.__face("east" if dx > 0 else "west", lambda: None)
+        else:
+            self.__face("north" if dy > 0 else "south", lambda: None)
+        self.start_animating()
+        super().move_path(run, continue_path)
+        return
+
     def change_state(self, state):
         """ Changes the state of the character.
 
@@ -2,9 +2,6 @@ import sys
 import os
 import random
 
-from queue import PriorityQueue
-import vertex as Vertex
-
 sys.path.insert(1, os.path.dirname(os.path.realpath(__file__)) + '/..')
 from enemy import Enemy
 
@@ -26,7 +23,7 @@ class Monkey(Enemy):
     def find_escape_path(self, callback = lambda: None):
         """ The monkey tries to find the nearest exit and escape!
 
-        Implemented using Djikstras
+        Takes one step along the shortest way to the edge of the area, then looks again, so it will find a new way round if it gets blocked in.
 
         Parameters
         ----------
@@ -35,89 +32,21 @@ class Monkey(Enemy):
 
         """
         engine = self.get_engine()
-        self_x, self_y = self.get_position()
         x_dim = 19
         y_dim = 19
 
-        vertex = [] 
-        #Accesses y then x
-
-        for y in range(y_dim):
-            new_list = []
-            for x in range(x_dim):
-                new_list.append(Vertex.Vertex(x,y))
-            vertex.append(new_list)
-
-
-        for y in range(y_dim):
-            for x in range(x_dim):
-                current = vertex[y][x]
-                #NORTH
-                if y + 1 < y_dim:
-                    if not engine.is_solid((x, y+1)):
-                        current.neighbors.append(vertex[y+1][x])
-                #SOUTH
-                if y - 1 >= 0:
-                    if not engine.is_solid((x, y-1)):
-                        current.neighbors.append(vertex[y-1][x])
-                #EAST
-                if x + 1 < x_dim:
-                    if not engine.is_solid((x+1, y)):
-                        current.neighbors.append(vertex[y][x+1])
-                #WEST
-                if x - 1 < x_dim:
-                    if not engine.is_solid((x-1, y)):
-                        current.neighbors.append(vertex[y][x-1])
-
-        pq = []
-        start = vertex[self_y][self_x]
-        start.distance = 0
-        pq.append(start)
-        end = start
-        start.parent = start
+        # Only edge tiles which can be walked on are a way out. Heading for a solid one would walk the monkey into a wall.
+        exits = [(x, y) for x in range(x_dim) for y in range(y_dim)
+                 if (x == 0 or x == x_dim - 1 or y == 0 or y == y_dim - 1) and not engine.is_solid((x, y))]
 
-        while(len(pq) != 0):
-            current = pq[0]
-            for v in pq:
-                if v < current:
-                    current = v
-            pq.remove(current)
-            
-            if current.x == 0 or current.x == x_dim - 1 or current.y == 0 or current.y == y_dim -1:
-                end = current
-                break
-
-            for neighbor in current.neighbors:
-                if current.distance + 1 < neighbor.distance and not neighbor.visited:
-                    neighbor.distance = current.distance + 1
-                    neighbor.parent = current
-                    if not neighbor in pq:
-                        pq.append(neighbor)
-
-            current.visited = True
-
-        if end != start:
-            while end.parent != start:
-                end = end.parent
-            if start.x + 1 == end.x:
-                self.move_east(lambda: self.find_escape_path())
-            elif start.x - 1 == end.x:
-                self.move_west(lambda: self.find_escape_path())
-            elif start.y + 1 == end.y:
-                self.move_north(lambda: self.find_escape_path())
-            elif start.y - 1 == end.y:
-                self.move_south(lambda: self.find_escape_path())
+        step = engine.get_flow_direction(self.get_position(), exits)
+        if step == (1, 0):
+            self.move_east(lambda: self.find_escape_path())
+        elif step == (-1, 0):
+            self.move_west(lambda: self.find_escape_path())
+        elif step == (0, 1):
+            self.move_north(lambda: self.find_escape_path())
+        elif step == (0, -1):
+            self.move_south(lambda: self.find_escape_path())
 
         engine.add_event(callback)
-            
-
-    
-
-
-        
-    
-
-
-
-
-
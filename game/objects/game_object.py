@@ -365,6 +365,21 @@ class GameObject:
         self.__entity.move_west(callback)
         return
 
+    def move_path(self, path, callback = lambda: None):
+        """ Smoothly slides this object along a path, one tile per step.
+
+        The whole path is walked by the engine, so this is much cheaper than chaining move_north etc. for long paths.
+
+        Parameters
+        ----------
+        path : list of 2 tuple of int
+            The steps to take, relative to the previous position, e.g. [(1, 0), (0, 1)] for east then north
+        callback : func, optional
+            Places the callback onto the engine event-queue once the path is finished, or as soon as a step is blocked
+        """
+        self.__entity.move_path(list(path), callback)
+        return
+
     def is_moving(self):
         """ Returns if this object is moving.
 
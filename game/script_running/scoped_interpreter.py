@@ -30,8 +30,8 @@ class ScopedInterpreter(code.InteractiveInterpreter):
 
         Parameters
         ----------
-        code : str
-            A string of the code you wish to run
+        code : str or code
+            A string of the code you wish to run, or the code already compiled
         HaltScriptException : Exception
             An instance of the exception class you wish to use to halt the executing script asynchronously
         """
@@ -49,12 +49,13 @@ class ScriptStateContainer:
     def halt_script(self):
         """ Halts the player script that is running.
 
-        Works by sending the thread the script is running in an Exception, which the thread catches and appropriately handles and
-        stops running.
+        Works by making every line the script runs raise an Exception, which the thread catches and appropriately handles and
+        stops running. Scripts which haven't started running lines yet are sent the Exception asynchronously instead.
         """
         if self.is_running_script():
             thread_id = self.get_thread_id()
-            res = ctypes.pythonapi.PyThreadState_SetAsyncExc(ctypes.c_long(thread_id), ctypes.py_object(scriptrunner.HaltScriptException))
+            if not self.get_engine().halt_script_thread(thread_id):
+                res = ctypes.pythonapi.PyThreadState_SetAsyncExc(ctypes.c_long(thread_id), ctypes.py_object(scriptrunner.HaltScriptException))
 
     def run_script(self, script_api, engine, callback = lambda: None):
         """ Runs the current script in the player_scripts folder in a seperate thread. Exposes the script_api to the script that is run.
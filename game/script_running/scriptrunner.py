@@ -13,6 +13,10 @@ from scoped_interpreter import ScopedInterpreter
 class HaltScriptException(Exception):
     pass
 
+class ScriptTimeoutException(HaltScriptException):
+    """ Raised in a script which has used up its processor time budget (see "scripting" in config.jsonnet) """
+    pass
+
 def start(script_api, script_name, script_state_container, engine, parse_error = True, callback = lambda: None):
     """ This function runs the script provided in the argument in a seperate thread.
 
@@ -208,6 +212,11 @@ def start(script_api, script_name, script_state_container, engine, parse_error =
     with open(script_filename, encoding="utf8") as script_file:
                 script = script_file.read()
 
+    #Reuse the code the PyScripter compiled when checking the script for syntax errors, if it is up to date
+    code = engine.get_compiled_script(script)
+    if code is None:
+        code = script
+
     def thread_target(callback):
         """ This is the method that is run in the seperate thread.
 
@@ -215,9 +224,17 @@ def start(script_api, script_name, script_state_container, engine, parse_error =
         the callback is therefore run in the seperate thread.
         """
 
+        def run_limited():
+            """ Runs the script with a budget, which halts it from here down once it has used too much processor time or halt_script is called """
+            engine.limit_script_thread(HaltScriptException, ScriptTimeoutException)
+            scoped_interpreter.runcode(code, HaltScriptException) #Run the script
+
         try:
             engine.set_error(False)
-            scoped_interpreter.runcode(script, HaltScriptException) #Run the script
+            run_limited()
+        except ScriptTimeoutException:
+            engine.print_terminal("Your script took too long to run, so it was stopped. Check for loops which never end!", True)
+            printed_flag[0] = True
         except HaltScriptException: #If an exception is sent to halt the script, catch it and act appropriately
             engine.print_terminal("Halted Script", True)
             printed_flag[0] = True
@@ -248,7 +265,10 @@ def make_blocking(async_function):
         lock = threading.Lock()
         lock.acquire()
         result = async_function(callback = lock.release) #run the async_function with the callback provided above as its argument
-        lock.acquire() # Try to a acquire a lock until it is released. It isn't released until the callback releases it.
+        # Try to a acquire a lock until it is released. It isn't released until the callback releases it.
+        # Wait a little at a time so that the script keeps running lines, and so can still be halted while it waits
+        while not lock.acquire(timeout = 0.05):
+            pass
         lock.release() # release the lock, it isn't needed anymore
         return result
 
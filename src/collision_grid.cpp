@@ -0,0 +1,108 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "collision_grid.hpp"
+
+CollisionGrid::CollisionGrid():
+    CollisionGrid(0, 0) {
+}
+
+CollisionGrid::CollisionGrid(int width, int height):
+    width(width),
+    height(height),
+    row_words((width + 63) / 64),
+    terrain_bits(std::size_t(row_words * height), 0),
+    solid_bits(std::size_t(row_words * height), 0),
+    block_counts(std::size_t(width * height), 0),
+    version(0) {
+}
+
+CollisionGrid::CollisionGrid(const CollisionGrid &other):
+    width(other.width),
+    height(other.height),
+    row_words(other.row_words),
+    terrain_bits(other.terrain_bits),
+    solid_bits(other.solid_bits),
+    block_counts(other.block_counts),
+    version(other.version) {
+}
+
+CollisionGrid &CollisionGrid::operator=(const CollisionGrid &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::lock_guard<std::mutex> lock(grid_lock);
+    width = other.width;
+    height = other.height;
+    row_words = other.row_words;
+    terrain_bits = other.terrain_bits;
+    solid_bits = other.solid_bits;
+    block_counts = other.block_counts;
+    // Don't go back to a version searches were cached for.
+    ++version;
+    return *this;
+}
+
+void CollisionGrid::update_solid(int x, int y) {
+    uint64_t bit(uint64_t(1) << (x % 64));
+    int word(y * row_words + x / 64);
+    bool solid(terrain_bits[word] & bit || block_counts[x + y * width] != 0);
+
+    if (bool(solid_bits[word] & bit) != solid) {
+        solid_bits[word] ^= bit;
+        ++version;
+    }
+}
+
+void CollisionGrid::set_terrain(int x, int y, bool solid) {
+    if (!in_bounds(x, y)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(grid_lock);
+
+    uint64_t bit(uint64_t(1) << (x % 64));
+    int word(y * row_words + x / 64);
+    if (solid) {
+        terrain_bits[word] |= bit;
+    } else {
+        terrain_bits[word] &= ~bit;
+    }
+    update_solid(x, y);
+}
+
+bool CollisionGrid::block(int x, int y) {
+    if (!in_bounds(x, y)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(grid_lock);
+
+    uint16_t &count(block_counts[x + y * width]);
+    if (count == UINT16_MAX) {
+        return false;
+    }
+    ++count;
+    update_solid(x, y);
+    return true;
+}
+
+bool CollisionGrid::unblock(int x, int y) {
+    if (!in_bounds(x, y)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(grid_lock);
+
+    // An extra unblock would otherwise wrap around to a full count.
+    uint16_t &count(block_counts[x + y * width]);
+    if (count == 0) {
+        return false;
+    }
+    --count;
+    update_solid(x, y);
+    return true;
+}
@@ -0,0 +1,137 @@
+#ifndef COLLISION_GRID_H
+#define COLLISION_GRID_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+///
+/// Which tiles of a map can't be walked on.
+///
+/// Tiles can be solid because of the terrain (set on the special layer)
+/// or because objects are blocking them, which is counted so several
+/// objects can block the same tile. Both are combined into one bitmap,
+/// kept up to date as they change, so a check is a load and a shift.
+///
+/// The bitmap is stored a row at a time, each row padded to a whole
+/// number of 64 bit words, with bit x % 64 of word x / 64 for column x.
+///
+/// Only the main thread changes the grid, and it locks get_lock() to do
+/// so. Other threads, such as script threads searching the grid, must
+/// hold that lock while they read it.
+///
+class CollisionGrid {
+private:
+    int width;
+    int height;
+
+    ///
+    /// The number of words in each row of a bitmap
+    ///
+    int row_words;
+
+    ///
+    /// Tiles which are solid terrain
+    ///
+    std::vector<uint64_t> terrain_bits;
+
+    ///
+    /// Tiles which are solid for any reason
+    ///
+    std::vector<uint64_t> solid_bits;
+
+    ///
+    /// How many blockers are on each tile, indexed by x + y * width
+    ///
+    std::vector<uint16_t> block_counts;
+
+    ///
+    /// Incremented whenever a tile becomes solid or stops being solid
+    ///
+    unsigned int version;
+
+    ///
+    /// Held while the grid changes, and while other threads read it
+    ///
+    mutable std::mutex grid_lock;
+
+    ///
+    /// Recompute the solid bit of a tile from its terrain bit and count
+    ///
+    void update_solid(int x, int y);
+
+public:
+    ///
+    /// Create an empty grid, with no tiles
+    ///
+    CollisionGrid();
+
+    ///
+    /// Create a grid with no solid tiles
+    ///
+    CollisionGrid(int width, int height);
+
+    ///
+    /// Copy the tiles, but not the lock
+    ///
+    CollisionGrid(const CollisionGrid &other);
+    CollisionGrid &operator=(const CollisionGrid &other);
+
+    ///
+    /// Get the lock which threads other than the main thread must hold
+    /// to read the grid
+    ///
+    std::mutex &get_lock() const { return grid_lock; }
+
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+
+    bool in_bounds(int x, int y) const {
+        return 0 <= x && x < width && 0 <= y && y < height;
+    }
+
+    ///
+    /// Is this tile solid, either as terrain or because it is blocked.
+    /// The tile must be in bounds.
+    ///
+    bool is_solid(int x, int y) const {
+        return (solid_bits[y * row_words + x / 64] >> (x % 64)) & 1;
+    }
+
+    ///
+    /// Is this tile solid terrain. The tile must be in bounds.
+    ///
+    bool is_terrain_solid(int x, int y) const {
+        return (terrain_bits[y * row_words + x / 64] >> (x % 64)) & 1;
+    }
+
+    ///
+    /// Set whether a tile is solid terrain. Ignored out of bounds.
+    ///
+    void set_terrain(int x, int y, bool solid);
+
+    ///
+    /// Add a blocker to a tile. Returns false if it is out of bounds or
+    /// already has as many blockers as can be counted.
+    ///
+    bool block(int x, int y);
+
+    ///
+    /// Remove a blocker from a tile. Returns false if it is out of bounds
+    /// or not blocked.
+    ///
+    bool unblock(int x, int y);
+
+    ///
+    /// Get the number of blockers on a tile. The tile must be in bounds.
+    ///
+    int get_block_count(int x, int y) const { return block_counts[x + y * width]; }
+
+    ///
+    /// Get the number of times a tile has become solid or stopped being
+    /// solid, so cached searches of the grid know when to start again
+    ///
+    unsigned int get_version() const { return version; }
+};
+
+#endif
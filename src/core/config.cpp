@@ -1,6 +1,8 @@
-#include <fstream>
-#include <stdio.h>
-#include <stdlib.h>
+#include <cmath>
+#include <glog/logging.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "config.hpp"
 
@@ -8,84 +10,127 @@ extern "C" {
     #include "jsonnet/libjsonnet.h"
 }
 
-// Hacky workaround to use jsonnet, calls the commandline application instead of using the C library :(
-std::string exec(const char* cmd) {
-    FILE* pipe = popen(cmd, "r");
-    if (!pipe) return "ERROR";
-    char buffer[128];
-    std::string result = "";
-    while(!feof(pipe)) {
-        if(fgets(buffer, 128, pipe) != NULL)
-            result += buffer;
-    }
-    pclose(pipe);
-    return result;
-}
-
 Config::json Config::j;
 bool Config::created = false;
-/*
-int bob(int argc, const char *fn)
-{
-    int error;
-    char *output;
-    struct JsonnetVm *vm;
-    if (argc != 2) {
-        fprintf(stderr, "libjsonnet_test_file <file>\n");
-        return EXIT_FAILURE;
+
+namespace {
+    ///
+    /// Builds a Config::json from the values libjsonnet passes to its
+    /// visitor, so the config is never written out as JSON text only to
+    /// be parsed again.
+    ///
+    struct Builder {
+        Config::json root;
+
+        ///
+        /// The arrays and objects being filled, innermost last.
+        ///
+        std::vector<Config::json *> containers;
+
+        ///
+        /// The key of the next value, if the innermost container is an
+        /// object.
+        ///
+        std::string key;
+
+        ///
+        /// Put a value in the innermost container, or make it the root.
+        ///
+        /// @return the value, where it was put
+        ///
+        Config::json &add(Config::json &&value) {
+            if (containers.empty()) {
+                root = std::move(value);
+                return root;
+            }
+
+            Config::json &container(*containers.back());
+            if (container.is_array()) {
+                container.push_back(std::move(value));
+                return container.back();
+            }
+            return container[key] = std::move(value);
+        }
+    };
+
+    Builder &builder(void *ctx) {
+        return *static_cast<Builder *>(ctx);
     }
-    vm = jsonnet_make();
-    output = jsonnet_evaluate_file(vm, fn, &error);
-    if (error) {
-        fprintf(stderr, "%s", output);
-        jsonnet_realloc(vm, output, 0);
-        jsonnet_destroy(vm);
-        return EXIT_FAILURE;
-    } 
-    printf("%s", output);
-    jsonnet_realloc(vm, output, 0);
-    jsonnet_destroy(vm);
-    return EXIT_SUCCESS;
+
+    int add_null(void *ctx) {
+        builder(ctx).add(nullptr);
+        return 0;
+    }
+
+    int add_boolean(void *ctx, int value) {
+        builder(ctx).add(value != 0);
+        return 0;
+    }
+
+    int add_number(void *ctx, double value) {
+        // Whole numbers are kept as integers, as parsing the JSON text
+        // would have done.
+        if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+            builder(ctx).add(static_cast<Config::json::number_integer_t>(value));
+        } else {
+            builder(ctx).add(value);
+        }
+        return 0;
+    }
+
+    int add_string(void *ctx, const char *value, size_t length) {
+        builder(ctx).add(std::string(value, length));
+        return 0;
+    }
+
+    int begin_array(void *ctx) {
+        Builder &b(builder(ctx));
+        b.containers.push_back(&b.add(Config::json::array()));
+        return 0;
+    }
+
+    int begin_object(void *ctx) {
+        Builder &b(builder(ctx));
+        b.containers.push_back(&b.add(Config::json::object()));
+        return 0;
+    }
+
+    int set_key(void *ctx, const char *key, size_t length) {
+        builder(ctx).key.assign(key, length);
+        return 0;
+    }
+
+    int end_container(void *ctx) {
+        builder(ctx).containers.pop_back();
+        return 0;
+    }
+
+    const JsonnetJsonVisitor config_visitor = {
+        add_null, add_boolean, add_number, add_string,
+        begin_array, end_container,
+        begin_object, set_key, end_container
+    };
 }
-*/
+
 Config::json Config::get_instance() {
-    /*
-    int error;
-    char *output;
-    struct JsonnetVm *vm;
-    vm = jsonnet_make();
-    output = jsonnet_evaluate_file(vm, "config.jsonnet", &error);
-    if (error) {
-        fprintf(stderr, "%s", output);
+    if(!created) {
+        Builder built;
+        int error;
+        struct JsonnetVm *vm = jsonnet_make();
+        char *output = jsonnet_evaluate_file_visit(vm, "config.jsonnet", &config_visitor, &built, &error);
+        std::string message(output);
         jsonnet_realloc(vm, output, 0);
         jsonnet_destroy(vm);
-        //TODO: handle error here in some way > terminate game and give helpful hint as to cause of problem?
-    }
-    LOG(INFO) << output; 
-    //print("%s", output);
-    jsonnet_realloc(vm, output, 0);
-    jsonnet_destroy(vm);
-    output = jsonnet_to_json("config.jsonnet");
-    */
-    if(!created) {
-        std::string output = exec("jsonnet/jsonnet config.jsonnet");
-        Config::j = Config::json::parse(output);
-        Config::created = true;
-    }
 
-    //bob(2, "config.jsonnet");
-  
-    /*if(!created) {
-        //std::string output = exec("jsonnet/jsonnet config.jsonnet");
-        int error;
-        char *output;
-        struct JsonnetVm *vm;
-        vm = jsonnet_make();
-        output = jsonnet_evaluate_file(vm, "config.jsonnet", &error);
-        Config::j = nlohmann::json::parse(output);
+        if (error) {
+            LOG(ERROR) << "Config: Could not evaluate config.jsonnet: " << message;
+            throw std::runtime_error("could not evaluate config.jsonnet");
+        }
+
+        Config::j = std::move(built.root);
         Config::created = true;
     }
-    */
+
     return Config::j;
 }
 
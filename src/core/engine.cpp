@@ -11,16 +11,19 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <deque>
 #include <glm/vec2.hpp>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <tuple>
 #include <vector>
 
 #include "audio_engine.hpp"
+#include "collision_grid.hpp"
 #include "dispatcher.hpp"
 #include "engine.hpp"
 #include "event_manager.hpp"
@@ -42,6 +45,7 @@ GameWindow* Engine::game_window(nullptr);
 MainWindow* Engine::main_window(nullptr);
 GUIMain* Engine::gui_main(nullptr);
 Challenge* Engine::challenge(nullptr);
+ScriptChecker* Engine::script_checker(nullptr);
 int Engine::tile_size(64);
 float Engine::global_scale(1.0f);
 
@@ -151,25 +155,44 @@ void Engine::move_object(int id, glm::ivec2 move_by, double duration, std::funct
     );
 }
 
+void Engine::move_path(int id, std::deque<glm::ivec2> path, double duration, std::function<void ()> func) {
+    auto object(ObjectManager::get_instance().get_object<MapObject>(id));
+
+    // Like move_object, a moving object is left alone.
+    if (path.empty() || !object || object->is_moving()) {
+        EventManager::get_instance()->add_event(func);
+        return;
+    }
+
+    glm::ivec2 step(path.front());
+    path.pop_front();
+
+    // Stop at an obstacle rather than walking on the spot.
+    glm::ivec2 target(glm::ivec2(object->get_game_position()) + step);
+    if (object->get_walkability() != Walkability::WALKABLE && !walkable(target)) {
+        EventManager::get_instance()->add_event(func);
+        return;
+    }
+
+    move_object(id, step, duration, [id, path, duration, func] () {
+        Engine::move_path(id, path, duration, func);
+    });
+}
+
 bool Engine::walkable(glm::ivec2 location) {
-    int map_width = map_viewer->get_map()->get_width();
-    int map_height = map_viewer->get_map()->get_height();
+    const CollisionGrid &collision_grid(map_viewer->get_map()->get_collision_grid());
+    // Scripts call this from their own threads.
+    std::lock_guard<std::mutex> lock(collision_grid.get_lock());
 
     // Check bounds
-    if(!(0 <= location.x && location.x < map_width) || !(0 <= location.y && location.y < map_height)) {
+    if(!collision_grid.in_bounds(location.x, location.y)) {
         VLOG(2) << "The object is moving off the map.";
         return true;
     }
 
-    // Check against collidable layer
-    if(!Engine::map_viewer->get_map()->is_walkable(location.x, location.y)) {
-        VLOG(2) << "Cannot move to requested tile due to collidable objects";
-        return false;
-    }
-
-    //check for tile blockers
-    if (get_map_viewer()->get_map()->blocker.at(location.x).at(location.y) != 0) {
-        VLOG(2) << "Cannot move to requested tile due to tile blocker";
+    // Check against the collidable layer and tile blockers
+    if(collision_grid.is_solid(location.x, location.y)) {
+        VLOG(2) << "Cannot move to requested tile due to collidable objects or tile blocker";
         return false;
     }
 
@@ -266,6 +289,12 @@ void Engine::add_text(std::string text) {
     });
 }
 
+void Engine::prerender_dialogue(std::deque<std::string> texts) {
+    EventManager::get_instance()->add_event([texts] {
+        gui_main->prerender_dialogue(texts);
+    });
+}
+
 void Engine::open_notification_bar(bool ignore_scripter, std::function<void ()> func){
 
     EventManager::get_instance()->add_event([func, ignore_scripter] {
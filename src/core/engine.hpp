@@ -7,6 +7,7 @@
 
 #include <boost/python/object_core.hpp>
 
+#include <deque>
 #include <glm/vec2.hpp>
 #include <string>
 #include <memory>
@@ -21,6 +22,7 @@
 class MainWindow;
 class GameMain;
 class MapViewer;
+class ScriptChecker;
 class TextBox;
 
 // Class wrapping the API calls into a static public class
@@ -37,6 +39,9 @@ private:
     static MainWindow* main_window;
 
     static Challenge* challenge;
+
+    static ScriptChecker* script_checker;
+
     ///
     /// The size of a tile
     ///
@@ -114,6 +119,18 @@ public:
     ///
     static MapViewer *get_map_viewer() { return map_viewer; }
 
+    ///
+    /// Set the syntax checker used for the player's scripts
+    /// @param _script_checker the checker owned by the game
+    ///
+    static void set_script_checker(ScriptChecker *_script_checker) { script_checker = _script_checker; }
+
+    ///
+    /// Get the syntax checker used for the player's scripts
+    /// @return a pointer to the script checker
+    ///
+    static ScriptChecker *get_script_checker() { return script_checker; }
+
     ///
     /// Move sprite onscreen
     ///
@@ -126,6 +143,20 @@ public:
     static void move_object(int id, glm::ivec2 move_by, double duration, std::function<void ()> func);
     static void move_object(int id, glm::ivec2 move_by);
 
+    ///
+    /// Move sprite onscreen along a path, one step after another
+    ///
+    /// The steps are chained in C++, so a path costs one callback
+    /// rather than one per step.
+    ///
+    /// @param id ID of sprite to move
+    /// @param path the relative moves to make, in order
+    /// @param duration the time each step takes
+    /// @param func the callback to be called once the path is finished, or
+    ///        a step is blocked (get's put on the event queue)
+    ///
+    static void move_path(int id, std::deque<glm::ivec2> path, double duration, std::function<void ()> func);
+
     ///
     /// Determine if a location can be walked on
     /// @param x_pos the x position to test
@@ -178,6 +209,7 @@ public:
 
     static void add_dialogue(std::string text);
     static void add_text(std::string text);
+    static void prerender_dialogue(std::deque<std::string> texts);
     static void open_notification_bar(bool ignore_scripting, std::function<void ()> func);
     static void open_notification_bar_with_options(bool ignore_scripting, std::deque<std::pair<std::string, std::function<void ()> > > _options);
     static void close_notification_bar();
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <glog/logging.h>
 #include <list>
@@ -83,7 +84,7 @@ void EventManager::flush_and_disable(InterpreterContext &interpreter_context) {
     // Lock released
 }
 
-void EventManager::process_events(InterpreterContext &interpreter_context) {
+bool EventManager::process_events(InterpreterContext &interpreter_context) {
     // We need to process all the events in the queue
     // Problem is that, when events are being processed, they can add
     // further events. If we have the lock on the lock_guard in the
@@ -94,8 +95,22 @@ void EventManager::process_events(InterpreterContext &interpreter_context) {
     // to do this. We then release the lock and process the event.
     // We then repeat the process until the entire queue is finished
     //
+    bool processed(false);
     while (true) {
 
+        //Check for an event before taking the GIL, so that an empty
+        //queue doesn't take the GIL away from the script threads.
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+
+            //If the queue is empty, exit this processing
+            if(curr_frame_queue->empty()) {
+                //This is safe as we have the lock
+                std::swap(curr_frame_queue, next_frame_queue);
+                break;
+            }
+        }
+
         //lock the Python GIL. Automatically unlocks it on destruction (when it goes out of scope).
         //neccesary for when there are python callbacks on the event queue. As they GIL needs to be locked when the are run and destructed.
         lock::GIL lock_gil(interpreter_context, "EventManager::process_events");
@@ -109,11 +124,9 @@ void EventManager::process_events(InterpreterContext &interpreter_context) {
             //Lock the list
             std::lock_guard<std::mutex> lock(queue_mutex);
 
-            //If the queue is empty, exit this processing
+            //The queue may have been flushed while waiting for the GIL
             if(curr_frame_queue->empty()) {
-                //This is safe as we have the lock
-                std::swap(curr_frame_queue, next_frame_queue);
-                break;
+                continue;
             }
 
             //Get the first element in the list
@@ -123,6 +136,7 @@ void EventManager::process_events(InterpreterContext &interpreter_context) {
         } // Lock released
 
         //Dispatch the callback
+        processed = true;
         if(func) {
             try {
                 func();
@@ -134,6 +148,8 @@ void EventManager::process_events(InterpreterContext &interpreter_context) {
             LOG(ERROR) << "ERROR in event_manager.cpp in processing, no function";
         }
     }
+
+    return processed;
 }
 void EventManager::add_event(std::function<void ()> func) {
     // Manages locking in an exception-safe manner
@@ -144,6 +160,15 @@ void EventManager::add_event(std::function<void ()> func) {
 
     //Add it to the queue
     next_frame_queue->push_back(func);
+    queue_changed.notify_one();
+}
+
+void EventManager::wait_for_events(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+
+    queue_changed.wait_until(lock, deadline, [this] () {
+        return !curr_frame_queue->empty() || !next_frame_queue->empty();
+    });
 }
 
 void EventManager::reenable() { enabled = true; }
@@ -1,6 +1,8 @@
 #ifndef EVENT_MANAGER_H
 #define EVENT_MANAGER_H
 
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <list>
 #include <mutex>
@@ -28,6 +30,11 @@ private:
     ///
     std::mutex queue_mutex;
 
+    ///
+    /// Signalled when an event is added, to wake wait_for_events.
+    ///
+    std::condition_variable queue_changed;
+
     ///
     ///The queue for lambdas to be dealt with in this frame
     /// We use a list as the iterator remains valid if we add and
@@ -125,7 +132,21 @@ public:
     ///
     /// Processes all events in the current frame queue
     ///
-    void process_events(InterpreterContext &interpreter_context);
+    /// The GIL is only taken while an event is run, so calling this
+    /// with nothing queued does not hold up Python threads.
+    ///
+    /// @return whether any events were run
+    ///
+    bool process_events(InterpreterContext &interpreter_context);
+
+    ///
+    /// Sleep until there are events to process or the deadline passes,
+    /// rather than polling process_events.
+    ///
+    /// @param deadline
+    ///     The latest time to return at.
+    ///
+    void wait_for_events(std::chrono::steady_clock::time_point deadline);
 
     ///
     /// Pauses the game so and stops running events
@@ -29,15 +29,18 @@
 #include "interpreter.hpp"
 #include "keyboard_input_event.hpp"
 #include "lifeline.hpp"
+#include "map_viewer.hpp"
 #include "mouse_cursor.hpp"
 #include "mouse_input_event.hpp"
 #include "mouse_state.hpp"
+#include "object_snapshots.hpp"
+#include "profiler.hpp"
 #include "sprite_manager.hpp"
+#include "text_font.hpp"
+#include "text.hpp"
 
 #ifdef USE_GLES
 #include "typeface.hpp"
-#include "text_font.hpp"
-#include "text.hpp"
 #endif
 
 //This class sets up the game and contains the game loop
@@ -50,9 +53,14 @@ GameMain::GameMain(int &argc, char **argv):
 
     embedWindow(argc, argv, this),
     interpreter(boost::filesystem::absolute("python_embed/wrapper_functions.so").normalize()),
+    script_checker(interpreter.interpreter_context),
     callbackstate(),
     em(EventManager::get_instance()),
     changing_challenge(false),
+    render_on_demand(false),
+    profiler_text(nullptr),
+    show_profiler(false),
+    profiler_text_countdown(0),
     player_name("???")
 
 {
@@ -60,6 +68,7 @@ GameMain::GameMain(int &argc, char **argv):
     gui = new GUIMain(&embedWindow);
 
     Config::json j = Config::get_instance();
+    render_on_demand = j["rendering"]["render_on_demand"];
     /// CREATE GLOBAL OBJECTS
 
     //Create the input manager
@@ -198,6 +207,16 @@ GameMain::GameMain(int &argc, char **argv):
     }
     ));
 
+    profiler_callback = input_manager->register_keyboard_handler(filter(
+    {KEY_PRESS, KEY("F3")},
+    [&] (KeyboardInputEvent)
+    {
+        show_profiler = !show_profiler;
+        profiler_text_countdown = 0;
+        MapViewer::invalidate();
+    }
+    ));
+
     script1_callback = input_manager->register_keyboard_handler(filter(
     {KEY_PRESS, KEY("1")},
     [&] (KeyboardInputEvent)
@@ -330,7 +349,13 @@ GameMain::GameMain(int &argc, char **argv):
     run_game = true;
     cursor = new MouseCursor(&embedWindow);
 
+    profiler_text = new Text(&embedWindow, Engine::get_game_font(), true);
+    profiler_text->set_colour(255, 255, 0, 255);
+    profiler_text->move_ratio(0.01f, 0.99f);
+    profiler_text->resize_ratio(0.5f, 0.5f);
+
     Engine::set_game_main(this);
+    Engine::set_script_checker(&script_checker);
 
     //Setup challenge
     challenge_data = (new ChallengeData(
@@ -372,6 +397,7 @@ GameMain::~GameMain()
 
     delete challenge_data;
     delete cursor;
+    delete profiler_text;
     LOG(INFO) << "Destructed GameMain..." << endl;
 }
 
@@ -432,17 +458,60 @@ void GameMain::game_loop(bool showMouse)
         last_clock = std::chrono::steady_clock::now();
 
         VLOG(3) << "} SB | IM {";
-        GameWindow::update();
+        {
+            Profiler::Timer timer(Profiler::INPUT);
+            GameWindow::update();
+        }
 
         VLOG(3) << "} IM | EM {";
 
-        do {
-            EventManager::get_instance()->process_events(interpreter.interpreter_context);
-        } while (std::chrono::steady_clock::now() - last_clock < std::chrono::nanoseconds(1000000000 / 60));
+        // Includes the time left idle before the next frame is due.
+        // While idle, sleep rather than spin, so the script threads can
+        // have the GIL and the CPU.
+        {
+            Profiler::Timer timer(Profiler::EVENTS);
+            auto next_frame(last_clock + std::chrono::nanoseconds(1000000000 / 60));
+            do {
+                // Callbacks queued by a pass run in the next one, so
+                // publish after every pass which ran anything. Otherwise
+                // a move's callback would see the object where it was
+                // before the move, and a chain such as a camera.move_to
+                // with time = 0.0 whose callback makes another move_to
+                // would work the second move out from the wrong place.
+                if (EventManager::get_instance()->process_events(interpreter.interpreter_context)) {
+                    ObjectSnapshots::get_instance().publish();
+                }
+                EventManager::get_instance()->wait_for_events(next_frame);
+            } while (std::chrono::steady_clock::now() < next_frame);
+        }
+
+        // Objects can also change outside of events, such as when a map
+        // is loaded
+        ObjectSnapshots::get_instance().publish();
+
+        // Updating the overlay every frame would make it unreadable.
+        if (show_profiler && --profiler_text_countdown <= 0) {
+            profiler_text->set_text(Profiler::get_instance()->get_summary());
+            profiler_text_countdown = 30;
+        }
+
+        //Only show SDL cursor on rapsberry pi, not required on desktop
+        #ifdef USE_GLES
+            //The cursor is drawn into the frame, so moving it needs a redraw
+            if (showMouse && input_manager->get_mouse_pixels() != last_mouse_pixels) {
+                last_mouse_pixels = input_manager->get_mouse_pixels();
+                MapViewer::invalidate();
+            }
+        #endif
+
+        // Leave the last frame on screen if nothing has changed since.
+        bool redraw(!render_on_demand || MapViewer::is_invalidated());
 
         VLOG(3) << "} EM | RM {";
         //std::cout << "calling render" << std::endl;
-        Engine::get_map_viewer()->render();
+        if (redraw) {
+            Engine::get_map_viewer()->render();
+        }
         VLOG(3) << "} RM | TD {";
 
         // This is not an input event, because the map can move with
@@ -459,11 +528,21 @@ void GameMain::game_loop(bool showMouse)
         //Only show SDL cursor on rapsberry pi, not required on desktop
         #ifdef USE_GLES
             //Display when mouse is over the SDL widget
-            if (showMouse) {cursor->display();};
+            if (showMouse && redraw) {cursor->display();};
         #endif
 
+        if (show_profiler && redraw) {
+            profiler_text->display();
+        }
+
         VLOG(3) << "} TD | SB {";
-        challenge_data->game_window->swap_buffers();
+        if (redraw) {
+            Profiler::Timer timer(Profiler::SWAP);
+            challenge_data->game_window->swap_buffers();
+        }
+
+        Profiler::get_instance()->record(Profiler::FRAME, last_clock, std::chrono::steady_clock::now());
+        Profiler::get_instance()->end_frame();
     }
     else{
         std::cout << "not running game loop" << std::endl;
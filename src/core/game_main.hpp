@@ -16,12 +16,14 @@
 #include "callback_state.hpp"
 #include "gui_main.hpp"
 #include "lifeline.hpp"
+#include "script_checker.hpp"
 
 class Challenge;
 class ChallengeData;
 class InputManager;
 class EventManager;
 class MouseCursor;
+class Text;
 
 class GameMain{
 private:
@@ -29,6 +31,7 @@ private:
     //Part of the game window interface
     GameWindow embedWindow;
     Interpreter interpreter;
+    ScriptChecker script_checker;
     InputManager* input_manager;
     GUIMain *gui;
     CallbackState callbackstate;
@@ -68,6 +71,7 @@ private:
     Lifeline script9_callback;
     Lifeline mouse_button_lifeline;
     Lifeline help_callback;
+    Lifeline profiler_callback;
     Lifeline switch_char;
     Lifeline text_lifeline_char;
 
@@ -84,6 +88,27 @@ private:
     bool changing_challenge;
     std::string next_challenge;
 
+    ///
+    /// Only redraw when MapViewer has been invalidated, rather than every frame.
+    ///
+    bool render_on_demand;
+
+    ///
+    /// Where the SDL cursor was last drawn, so moving it redraws the scene.
+    ///
+    std::pair<int,int> last_mouse_pixels;
+
+    ///
+    /// Overlay of the profiler's frame timings, toggled with F3.
+    ///
+    Text *profiler_text;
+    bool show_profiler;
+
+    ///
+    /// Frames until the profiler overlay is next updated.
+    ///
+    int profiler_text_countdown;
+
 
 public:
 
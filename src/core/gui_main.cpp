@@ -832,6 +832,28 @@ void GUIMain::add_text(std::string text){
     notification_bar->add_text(text);
 }
 
+void GUIMain::prerender_dialogue(std::deque<std::string> texts){
+    auto pages = std::make_shared<std::deque<std::string>>();
+    for(std::string text : texts){
+        for(std::string page : notification_bar->paginate(text)){
+            pages->push_back(page);
+        }
+    }
+    prerender_pages(pages);
+}
+
+void GUIMain::prerender_pages(std::shared_ptr<std::deque<std::string>> pages){
+    if(pages->empty()) return;
+
+    notification_bar->prerender(pages->front());
+    pages->pop_front();
+
+    //Yield back to the event loop, so the game loop can stop once the frame's time is up
+    EventManager::get_instance()->add_event([this, pages] {
+        prerender_pages(pages);
+    });
+}
+
 void GUIMain::add_button(std::string file_path, std::string name, std::function<void (void)> callback, unsigned int button_id)
 {
     if(buttons.size() == button_max)
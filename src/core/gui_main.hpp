@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <deque>
+#include <string>
 #include <utility>
 
 #include "button.hpp"
@@ -140,6 +141,8 @@ private:
     bool callback_options; //whether or not there are options at the end of the notification bar
     bool ignored_scripter_state;
     void create_notification_bar();
+    //Render the next page of a conversation, then queue the rest for later events
+    void prerender_pages(std::shared_ptr<std::deque<std::string>> pages);
 
     std::shared_ptr<TextBox> notification_bar;
     std::shared_ptr<TextBox> external_script_help;
@@ -241,6 +244,10 @@ public:
     void add_message(std::string text);
     void add_text(std::string text);
 
+    //Render the pages of dialogue which are going to be shown soon, so that they display without a stall
+    //This is spread out over the idle time in the event loop, a page at a time
+    void prerender_dialogue(std::deque<std::string> texts);
+
     //To open and close the notification bar, func is the callback function to be called after the user finished reading the notification
     void open_notification_bar(std::function<void ()> func, bool ignore_scripter);
     void open_notification_bar_with_options(std::deque<std::pair<std::string, std::function<void ()> > > options, bool ignore_scripter);
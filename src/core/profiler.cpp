@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <glog/logging.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiler.hpp"
+
+// std::min takes these by reference, so they need a definition.
+const std::size_t Profiler::history_frames;
+const std::size_t Profiler::trace_capacity;
+
+Profiler::Timer::Timer(Section section):
+    section(section),
+    start(std::chrono::steady_clock::now()) {
+}
+
+Profiler::Timer::~Timer() {
+    Profiler::get_instance()->record(section, start, std::chrono::steady_clock::now());
+}
+
+Profiler *Profiler::get_instance() {
+    // Lazy instantiation of the global instance
+    static Profiler global_instance;
+
+    return &global_instance;
+}
+
+const char *Profiler::get_section_name(Section section) {
+    switch (section) {
+    case INPUT:         return "input";
+    case EVENTS:        return "events";
+    case GIL_WAIT:      return "gil wait";
+    case MAP_RENDER:    return "map render";
+    case OBJECT_RENDER: return "object render";
+    case GUI_RENDER:    return "gui render";
+    case SWAP:          return "swap";
+    case FRAME:         return "frame";
+    default:            return "unknown";
+    }
+}
+
+Profiler::Profiler():
+    main_thread(std::thread::id()),
+    epoch(std::chrono::steady_clock::now()),
+    frames(history_frames),
+    next_frame(0),
+    frame_count(0),
+    trace(trace_capacity),
+    next_trace_event(0),
+    trace_event_count(0) {
+    current_frame.fill(0.0);
+}
+
+void Profiler::record(Section section,
+                      std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end) {
+    // No thread has the default id, so nothing is timed before the
+    // first end_frame.
+    if (std::this_thread::get_id() != main_thread.load()) {
+        return;
+    }
+
+    current_frame[section] += std::chrono::duration<double, std::milli>(end - start).count();
+
+    int64_t duration_us(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    if (duration_us < trace_threshold_us) {
+        return;
+    }
+
+    trace[next_trace_event] = TraceEvent{
+        section,
+        std::chrono::duration_cast<std::chrono::microseconds>(start - epoch).count(),
+        duration_us
+    };
+    next_trace_event = (next_trace_event + 1) % trace_capacity;
+    trace_event_count = std::min(trace_event_count + 1, trace_capacity);
+}
+
+void Profiler::end_frame() {
+    if (main_thread.load() == std::thread::id()) {
+        main_thread.store(std::this_thread::get_id());
+    }
+
+    frames[next_frame] = current_frame;
+    next_frame = (next_frame + 1) % history_frames;
+    frame_count = std::min(frame_count + 1, history_frames);
+
+    current_frame.fill(0.0);
+}
+
+double Profiler::get_percentile(Section section, double percentile) {
+    if (frame_count == 0) {
+        return 0.0;
+    }
+
+    std::vector<double> times;
+    times.reserve(frame_count);
+    for (std::size_t i = 0; i < frame_count; ++i) {
+        times.push_back(frames[i][section]);
+    }
+
+    auto nth(std::begin(times) + std::size_t(percentile / 100.0 * double(frame_count - 1) + 0.5));
+    std::nth_element(std::begin(times), nth, std::end(times));
+    return *nth;
+}
+
+std::string Profiler::get_summary() {
+    std::stringstream summary;
+    summary << std::fixed << std::setprecision(2);
+    summary << "frame time (ms)  p50  p99";
+    for (int section = 0; section < SECTION_COUNT; ++section) {
+        summary << "\n" << get_section_name(Section(section))
+                << "  " << get_percentile(Section(section), 50.0)
+                << "  " << get_percentile(Section(section), 99.0);
+    }
+    return summary.str();
+}
+
+bool Profiler::export_csv(std::string filename) {
+    std::ofstream file(filename);
+
+    for (int section = 0; section < SECTION_COUNT; ++section) {
+        file << (section ? "," : "") << get_section_name(Section(section));
+    }
+    file << "\n";
+
+    // Oldest frame first.
+    std::size_t first((next_frame + history_frames - frame_count) % history_frames);
+    for (std::size_t i = 0; i < frame_count; ++i) {
+        auto &frame(frames[(first + i) % history_frames]);
+        for (int section = 0; section < SECTION_COUNT; ++section) {
+            file << (section ? "," : "") << frame[section];
+        }
+        file << "\n";
+    }
+
+    if (!file) {
+        LOG(WARNING) << "Unable to write profile to \"" << filename << "\"";
+        return false;
+    }
+
+    LOG(INFO) << "Wrote " << frame_count << " profiled frames to \"" << filename << "\"";
+    return true;
+}
+
+bool Profiler::export_chrome_trace(std::string filename) {
+    std::ofstream file(filename);
+
+    // Complete ("X") events, all on one thread since only the main
+    // thread is timed.
+    file << "{\"traceEvents\":[";
+    std::size_t first((next_trace_event + trace_capacity - trace_event_count) % trace_capacity);
+    for (std::size_t i = 0; i < trace_event_count; ++i) {
+        auto &event(trace[(first + i) % trace_capacity]);
+        file << (i ? ",\n" : "\n")
+             << "{\"name\":\"" << get_section_name(event.section) << "\","
+             << "\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+             << "\"ts\":" << event.start_us << ","
+             << "\"dur\":" << event.duration_us << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if (!file) {
+        LOG(WARNING) << "Unable to write profile trace to \"" << filename << "\"";
+        return false;
+    }
+
+    LOG(INFO) << "Wrote " << trace_event_count << " profiled intervals to \"" << filename << "\"";
+    return true;
+}
@@ -0,0 +1,179 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+///
+/// Frame profiler for the game loop, which uses the singleton pattern.
+///
+/// Time spent in each section of a frame is added up with scoped
+/// Timers, and the totals of the last history_frames frames are kept
+/// in a ring buffer for percentiles and export. Only the main thread
+/// (the one calling end_frame) is timed, so Python threads taking the
+/// GIL don't show up as frame time.
+///
+class Profiler {
+public:
+    ///
+    /// The parts of a frame which are timed.
+    ///
+    enum Section {
+        INPUT,
+        EVENTS,
+        GIL_WAIT,
+        MAP_RENDER,
+        OBJECT_RENDER,
+        GUI_RENDER,
+        SWAP,
+        FRAME,
+        SECTION_COUNT
+    };
+
+    ///
+    /// Times its own lifetime and adds it to a section.
+    ///
+    class Timer {
+    private:
+        Section section;
+        std::chrono::steady_clock::time_point start;
+    public:
+        Timer(Section section);
+        ~Timer();
+
+        Timer(Timer const&) = delete;
+        void operator=(Timer const&) = delete;
+    };
+
+    ///
+    /// Getter for the global profiler.
+    /// @return a pointer to the global profiler
+    ///
+    static Profiler* get_instance();
+
+    ///
+    /// Get the name of a section, as shown in the overlay and exports.
+    ///
+    static const char* get_section_name(Section section);
+
+    ///
+    /// Add a timed interval to the current frame.
+    ///
+    /// Ignored if not called from the main thread.
+    ///
+    void record(Section section,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+    ///
+    /// Store the totals of the current frame and start a new one.
+    ///
+    /// The first call decides which thread is the main thread.
+    ///
+    void end_frame();
+
+    ///
+    /// Get a percentile of the time spent in a section per frame,
+    /// over the recorded frames.
+    ///
+    /// @param section
+    ///     The section.
+    /// @param percentile
+    ///     Between 0 and 100.
+    /// @return
+    ///     The time in milliseconds, or 0 if no frames are recorded.
+    ///
+    double get_percentile(Section section, double percentile);
+
+    ///
+    /// Get a human-readable table of the p50 and p99 times of every
+    /// section, one line per section.
+    ///
+    std::string get_summary();
+
+    ///
+    /// Write the recorded frames as CSV, with one row per frame and a
+    /// column per section, in milliseconds.
+    ///
+    /// @return Whether the file was written.
+    ///
+    bool export_csv(std::string filename);
+
+    ///
+    /// Write the recorded intervals in the Chrome trace event format,
+    /// which can be opened in chrome://tracing.
+    ///
+    /// @return Whether the file was written.
+    ///
+    bool export_chrome_trace(std::string filename);
+
+private:
+    Profiler();
+
+    Profiler(Profiler const&) = delete;
+    void operator=(Profiler const&) = delete;
+
+    ///
+    /// Number of frames kept, about ten seconds at 60 frames per second.
+    ///
+    static const std::size_t history_frames = 600;
+
+    ///
+    /// Number of intervals kept for the trace export.
+    ///
+    static const std::size_t trace_capacity = 32768;
+
+    ///
+    /// Intervals shorter than this are added to the frame totals but
+    /// are left out of the trace. Otherwise the event loop's many
+    /// uncontended GIL acquisitions would flood it.
+    ///
+    static const int64_t trace_threshold_us = 20;
+
+    ///
+    /// An interval for the trace export.
+    ///
+    struct TraceEvent {
+        Section section;
+        int64_t start_us;
+        int64_t duration_us;
+    };
+
+    ///
+    /// The thread that calls end_frame, or no thread until it first
+    /// does. Timers on other threads read it, so it is atomic.
+    ///
+    std::atomic<std::thread::id> main_thread;
+
+    ///
+    /// When the profiler was created, which trace times are relative to.
+    ///
+    std::chrono::steady_clock::time_point epoch;
+
+    ///
+    /// Totals of the frame in progress, in milliseconds.
+    ///
+    std::array<double, SECTION_COUNT> current_frame;
+
+    ///
+    /// Ring buffer of frame totals, in milliseconds.
+    ///
+    std::vector<std::array<double, SECTION_COUNT>> frames;
+    std::size_t next_frame;
+    std::size_t frame_count;
+
+    ///
+    /// Ring buffer of intervals for the trace export.
+    ///
+    std::vector<TraceEvent> trace;
+    std::size_t next_trace_event;
+    std::size_t trace_event_count;
+};
+
+#endif
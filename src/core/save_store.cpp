@@ -0,0 +1,177 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <glog/logging.h>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "config.hpp"
+#include "save_store.hpp"
+
+SaveStore::SaveStore():
+    version(0),
+    written_version(0),
+    flush_requested(false),
+    stopping(false) {
+
+    Config::json j = Config::get_instance();
+    std::string game_save_location = j["files"]["game_save_location"];
+    filename = game_save_location;
+    write_delay_ms = j["saving"]["write_delay_ms"];
+    minify = j["saving"]["minify"];
+
+    std::ifstream save_file(filename);
+    std::stringstream contents;
+    contents << save_file.rdbuf();
+    try {
+        if (!save_file) {
+            throw std::runtime_error("could not read file");
+        }
+        document = Config::json::parse(contents.str());
+    } catch (std::exception &error) {
+        LOG(ERROR) << "SaveStore: Could not load " << filename << " (" << error.what() << "), starting with an empty save";
+    }
+
+    if (!document.is_object()) {
+        document = Config::json::object();
+    }
+
+    writer = std::thread(&SaveStore::write_loop, this);
+}
+
+SaveStore::~SaveStore() {
+    {
+        std::lock_guard<std::mutex> lock(store_lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+SaveStore &SaveStore::get_instance() {
+    //Lazy instantiation of the global instance
+    static SaveStore global_instance;
+    return global_instance;
+}
+
+std::string SaveStore::get(std::string section, std::string key) {
+    std::lock_guard<std::mutex> lock(store_lock);
+
+    if (!document.count(section)) {
+        return "null";
+    }
+    if (key.empty()) {
+        return document[section].dump();
+    }
+    // count throws if the section isn't an object
+    if (!document[section].is_object() || !document[section].count(key)) {
+        return "null";
+    }
+    return document[section][key].dump();
+}
+
+bool SaveStore::has(std::string section, std::string key) {
+    std::lock_guard<std::mutex> lock(store_lock);
+
+    if (!document.count(section)) {
+        return false;
+    }
+    if (key.empty()) {
+        return true;
+    }
+    // count throws if the section isn't an object
+    return document[section].is_object() && document[section].count(key) != 0;
+}
+
+void SaveStore::set(std::string section, std::string key, std::string value) {
+    // Parse outside the lock, so the writer isn't held up
+    Config::json parsed(Config::json::parse(value));
+
+    {
+        std::lock_guard<std::mutex> lock(store_lock);
+
+        if (key.empty()) {
+            document[section] = parsed;
+        } else {
+            if (!document[section].is_object()) {
+                document[section] = Config::json::object();
+            }
+            document[section][key] = parsed;
+        }
+        ++version;
+    }
+    changed.notify_all();
+}
+
+void SaveStore::flush() {
+    std::unique_lock<std::mutex> lock(store_lock);
+
+    unsigned long flush_version(version);
+    if (written_version >= flush_version) {
+        return;
+    }
+
+    flush_requested = true;
+    changed.notify_all();
+    written.wait(lock, [&] () { return written_version >= flush_version; });
+}
+
+void SaveStore::write_loop() {
+    std::unique_lock<std::mutex> lock(store_lock);
+
+    while (true) {
+        changed.wait(lock, [&] () { return stopping || version != written_version; });
+        if (version == written_version) {
+            // Stopping, with everything written
+            return;
+        }
+
+        // Give any related changes a chance to come in before writing.
+        changed.wait_for(lock, std::chrono::milliseconds(write_delay_ms), [&] () {
+            return stopping || flush_requested;
+        });
+        flush_requested = false;
+
+        // Copy the save so it can be serialised and written without
+        // keeping anyone waiting for the lock.
+        unsigned long writing_version(version);
+        Config::json snapshot(document);
+        lock.unlock();
+
+        write_file(minify ? snapshot.dump() : snapshot.dump(4));
+
+        lock.lock();
+        written_version = writing_version;
+        written.notify_all();
+    }
+}
+
+bool SaveStore::write_file(const std::string &contents) {
+    std::string temporary_filename(filename + ".tmp");
+
+    FILE *save_file = fopen(temporary_filename.c_str(), "w");
+    if (!save_file) {
+        LOG(ERROR) << "SaveStore: Could not open " << temporary_filename;
+        return false;
+    }
+
+    // Make sure the new save is on disk before it replaces the old one,
+    // or a crash could leave neither.
+    bool saved = fwrite(contents.data(), 1, contents.size(), save_file) == contents.size()
+                && fflush(save_file) == 0
+                && fsync(fileno(save_file)) == 0;
+    saved = fclose(save_file) == 0 && saved;
+
+    if (!saved || std::rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        LOG(ERROR) << "SaveStore: Could not write " << filename;
+        std::remove(temporary_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,135 @@
+#ifndef SAVE_STORE_H
+#define SAVE_STORE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "config.hpp"
+
+///
+/// Holds the save game (save.json) in memory, and writes it back to disk
+/// on a background thread.
+///
+/// Changes are saved a short while after they are made, so a burst of
+/// them (such as picking up several coins) is written once. The file is
+/// written next to the save and renamed over it, so a crash part of the
+/// way through a write can't corrupt the save.
+///
+/// The save is a JSON object of sections ("settings", "player_saves",
+/// ...), which are themselves JSON objects. Values are passed in and out
+/// as JSON text.
+///
+/// Thread safe.
+///
+class SaveStore {
+private:
+    std::mutex store_lock;
+
+    ///
+    /// Notified when the save changes, or when the writer is stopping.
+    ///
+    std::condition_variable changed;
+
+    ///
+    /// Notified when the writer has written a version of the save.
+    ///
+    std::condition_variable written;
+
+    Config::json document;
+
+    std::string filename;
+
+    ///
+    /// How long to wait after a change before writing, so that changes
+    /// made in quick succession are written together.
+    ///
+    int write_delay_ms;
+
+    ///
+    /// Whether to write the save without indentation.
+    ///
+    bool minify;
+
+    ///
+    /// Incremented on every change.
+    ///
+    unsigned long version;
+
+    ///
+    /// The version last written, or attempted.
+    ///
+    unsigned long written_version;
+
+    ///
+    /// Whether someone is waiting in flush, so the writer shouldn't delay.
+    ///
+    bool flush_requested;
+
+    bool stopping;
+
+    std::thread writer;
+
+    SaveStore();
+    ~SaveStore();
+
+    ///
+    /// Write changes until stopping, then write any left over.
+    ///
+    void write_loop();
+
+    ///
+    /// Atomically replace the save file with the given contents.
+    ///
+    /// @return whether the file was written
+    ///
+    bool write_file(const std::string &contents);
+
+public:
+    static SaveStore &get_instance();
+
+    SaveStore(SaveStore const&) = delete;
+    void operator=(SaveStore const&) = delete;
+
+    ///
+    /// Get a value from the save.
+    ///
+    /// @param section
+    ///     The top-level key, such as "settings".
+    ///
+    /// @param key
+    ///     The key within the section, or an empty string for the
+    ///     whole section.
+    ///
+    /// @return the value as JSON text, or "null" if there isn't one
+    ///
+    std::string get(std::string section, std::string key);
+
+    ///
+    /// @return whether the save has a value for the key in the section
+    ///
+    bool has(std::string section, std::string key);
+
+    ///
+    /// Change a value in the save. It is written to disk soon after.
+    ///
+    /// @param section
+    ///     The top-level key, such as "player_saves".
+    ///
+    /// @param key
+    ///     The key within the section, or an empty string to replace the
+    ///     whole section.
+    ///
+    /// @param value
+    ///     JSON text.
+    ///
+    void set(std::string section, std::string key, std::string value);
+
+    ///
+    /// Wait until every change made so far has been written to disk.
+    ///
+    void flush();
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dialogue_table.hpp"
+
+DialogueTable &DialogueTable::get_instance() {
+    static DialogueTable global_instance;
+    return global_instance;
+}
+
+std::string DialogueTable::make_key(const std::string &level, const std::string &identifier) {
+    // Neither can contain a newline, so the key is unambiguous
+    return level + '\n' + identifier;
+}
+
+void DialogueTable::load(std::string language, const std::vector<Line> &lines) {
+    std::unordered_map<std::string, Template> loaded;
+    loaded.reserve(lines.size());
+
+    for (auto &line : lines) {
+        Template &dialogue(loaded[make_key(line.level, line.identifier)]);
+        dialogue.text = line.text;
+
+        for (auto marker = line.text.find('%'); marker != std::string::npos; marker = line.text.find('%', marker + 1)) {
+            dialogue.markers.push_back(marker);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(table_lock);
+    this->language = language;
+    templates.swap(loaded);
+}
+
+std::string DialogueTable::get_language() {
+    std::lock_guard<std::mutex> lock(table_lock);
+    return language;
+}
+
+std::string DialogueTable::get(const std::string &level, const std::string &identifier, const std::map<std::string, std::string> &escapes) {
+    std::lock_guard<std::mutex> lock(table_lock);
+
+    auto found(templates.find(make_key(level, identifier)));
+    if (found == std::end(templates)) {
+        return "invalid dialogue identifier";
+    }
+
+    const Template &dialogue(found->second);
+    if (escapes.empty()) {
+        return dialogue.text;
+    }
+
+    // Copy up to each pair of markers, and replace what's between them if
+    // it's an escape. If it isn't, the closing marker may open an escape
+    // itself, so only the opening one is used up.
+    std::string result;
+    result.reserve(dialogue.text.size());
+
+    std::string::size_type copied(0);
+    auto &markers(dialogue.markers);
+    for (std::vector<std::string::size_type>::size_type i = 0; i + 1 < markers.size(); ++i) {
+        auto open(markers[i]);
+        auto close(markers[i + 1]);
+        if (open < copied) {
+            continue;
+        }
+
+        auto escape(escapes.find(dialogue.text.substr(open + 1, close - open - 1)));
+        if (escape != std::end(escapes)) {
+            result.append(dialogue.text, copied, open - copied);
+            result.append(escape->second);
+            copied = close + 1;
+        }
+    }
+    result.append(dialogue.text, copied, std::string::npos);
+
+    return result;
+}
@@ -0,0 +1,93 @@
+#ifndef DIALOGUE_TABLE_H
+#define DIALOGUE_TABLE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+///
+/// The game's dialogue in one language, loaded from the dialogue
+/// database once so that looking up a line doesn't need a query.
+///
+/// Dialogue can contain escapes such as %player_name%, which are
+/// replaced when the line is looked up. Where the % signs are in each
+/// line is worked out when it is loaded.
+///
+/// Thread safe.
+///
+class DialogueTable {
+private:
+    struct Template {
+        std::string text;
+
+        ///
+        /// The positions of every % in text, in order.
+        ///
+        std::vector<std::string::size_type> markers;
+    };
+
+    std::mutex table_lock;
+
+    ///
+    /// The language loaded, or empty if nothing has been loaded.
+    ///
+    std::string language;
+
+    ///
+    /// Templates by make_key(level, identifier).
+    ///
+    std::unordered_map<std::string, Template> templates;
+
+    static std::string make_key(const std::string &level, const std::string &identifier);
+
+    DialogueTable() {};
+
+public:
+    ///
+    /// A line of dialogue to load.
+    ///
+    struct Line {
+        std::string level;
+        std::string identifier;
+        std::string text;
+    };
+
+    static DialogueTable &get_instance();
+
+    DialogueTable(DialogueTable const&) = delete;
+    void operator=(DialogueTable const&) = delete;
+
+    ///
+    /// Replace the table with the given lines.
+    ///
+    /// @param language
+    ///     The language the lines are in.
+    ///
+    void load(std::string language, const std::vector<Line> &lines);
+
+    ///
+    /// @return the language loaded, or an empty string if none has been
+    ///
+    std::string get_language();
+
+    ///
+    /// Look up a line of dialogue, replacing its escapes in one pass.
+    ///
+    /// @param level
+    ///     The level the dialogue belongs to, such as "/world1/intro" or "shared".
+    ///
+    /// @param identifier
+    ///     The name of the line within the level.
+    ///
+    /// @param escapes
+    ///     Replacements by escape name, without the % signs. Escapes
+    ///     not given are left as they are.
+    ///
+    /// @return the line, or "invalid dialogue identifier" if there isn't one
+    ///
+    std::string get(const std::string &level, const std::string &identifier, const std::map<std::string, std::string> &escapes);
+};
+
+#endif
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <glog/logging.h>
+
+extern "C" {
+#include <SDL2/SDL_ttf.h>
+}
+
+#include "cacheable_resource.hpp"
+#include "font_atlas.hpp"
+#include "resource_cache.hpp"
+
+
+
+// Need to inherit constructors manually.
+// NOTE: This will, and are required to, copy the message.
+FontAtlas::LoadException::LoadException(const char *message): std::runtime_error(message) {}
+FontAtlas::LoadException::LoadException(const std::string &message): std::runtime_error(message) {}
+
+
+
+///
+/// Identifies the cache file format. Change it when the layout changes.
+///
+static const char cache_magic[4] = {'S', 'D', 'F', '2'};
+
+///
+/// The ranges of code points put in the atlas: printable ASCII and
+/// Latin-1.
+///
+static const uint32_t code_point_ranges[][2] = {
+    {0x20, 0x7e},
+    {0xa0, 0xff}
+};
+
+
+template<typename T>
+static void write_value(std::ofstream &file, T value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<typename T>
+static T read_value(std::ifstream &file) {
+    T value = T();
+    file.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+///
+/// Largest atlas height accepted from a cache file.
+///
+static const int max_field_height = 4096;
+
+///
+/// Whether TTF_RenderGlyph_Shaded renders the whole cell of a glyph,
+/// rather than only its bitmap. SDL_ttf does from 2.0.18.
+///
+static bool renders_whole_cell() {
+    const SDL_version *linked = TTF_Linked_Version();
+    return SDL_VERSIONNUM(linked->major, linked->minor, linked->patch) >= SDL_VERSIONNUM(2, 0, 18);
+}
+
+static std::time_t get_modification_time(const std::string filename) {
+    boost::system::error_code error;
+    std::time_t time = boost::filesystem::last_write_time(filename, error);
+    return error ? 0 : time;
+}
+
+
+
+std::shared_ptr<FontAtlas> FontAtlas::new_resource(const std::string resource_name) {
+    return std::make_shared<FontAtlas>(resource_name);
+}
+
+FontAtlas::FontAtlas(const std::string filename):
+    CacheableResource(),
+    field_width(0),
+    field_height(0),
+    line_height(0),
+    gl_texture(0) {
+
+    if (!load_cache(filename)) {
+        generate(filename);
+        save_cache(filename);
+    }
+
+    glGenTextures(1, &gl_texture);
+
+    if (gl_texture == 0) {
+        LOG(ERROR) << "Unable to generate GL texture for font atlas \"" << filename << "\".";
+        throw FontAtlas::LoadException("Unable to generate GL texture");
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, gl_texture);
+    // The rows are one byte per pixel, so are not 4-byte aligned.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, field_width, field_height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, field.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Interpolating the distances is what keeps scaled edges sharp.
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Only the GL copy is needed from now on.
+    field.clear();
+    field.shrink_to_fit();
+}
+
+FontAtlas::~FontAtlas() {
+    glDeleteTextures(1, &gl_texture);
+    VLOG(1) << "Deleted font atlas " << resource_name;
+}
+
+
+void FontAtlas::generate(const std::string filename) {
+    if (!TTF_WasInit() && TTF_Init() == -1) {
+        LOG(ERROR) << "Failure initializing SDL_ttf: " << TTF_GetError();
+        throw FontAtlas::LoadException("Failure initializing SDL_ttf");
+    }
+
+    TTF_Font* font = TTF_OpenFont(filename.c_str(), base_size);
+
+    if (font == nullptr) {
+        LOG(ERROR) << "Unable to open font from file \"" << filename << "\" at size " << base_size << ": " << TTF_GetError();
+        throw FontAtlas::LoadException("Unable to open font");
+    }
+
+    LOG(INFO) << "Generating font atlas for \"" << filename << "\"...";
+
+    line_height = TTF_FontHeight(font);
+    int ascent = TTF_FontAscent(font);
+    bool whole_cell = renders_whole_cell();
+
+    // The glyph distance fields, packed into rows once they are all known.
+    std::map<uint32_t, std::vector<uint8_t>> cells;
+
+    SDL_Color white{255, 255, 255, 255};
+    SDL_Color black{0, 0, 0, 255};
+
+    for (auto &range : code_point_ranges) {
+        for (uint32_t code_point = range[0]; code_point <= range[1]; ++code_point) {
+            if (!TTF_GlyphIsProvided(font, (Uint16)code_point)) {
+                continue;
+            }
+
+            int min_x, max_y, advance;
+            TTF_GlyphMetrics(font, (Uint16)code_point, &min_x, nullptr, nullptr, &max_y, &advance);
+
+            // Where the rendered surface goes, relative to the pen at the
+            // top of the line. Older SDL_ttf renders only the glyph's
+            // bitmap, which has to be placed by its bearing. Newer
+            // versions render the whole cell, and only grow it up or
+            // left for glyphs that stick out of it.
+            int left = min_x;
+            int top = ascent - max_y;
+            if (whole_cell) {
+                left = std::min(left, 0);
+                top = std::min(top, 0);
+            }
+
+            // Shaded glyphs are 8-bit, with the palette index giving the coverage.
+            SDL_Surface* surface = TTF_RenderGlyph_Shaded(font, (Uint16)code_point, white, black);
+            if (surface == nullptr) {
+                LOG(WARNING) << "Cannot render glyph " << code_point << ": " << TTF_GetError();
+                continue;
+            }
+
+            SDL_LockSurface(surface);
+            int sw = surface->w;
+            int sh = surface->h;
+            std::vector<bool> inside(sw * sh);
+            for (int y = 0; y < sh; ++y) {
+                for (int x = 0; x < sw; ++x) {
+                    inside[y * sw + x] = ((Uint8*)surface->pixels)[y * surface->pitch + x] >= 128;
+                }
+            }
+            SDL_UnlockSurface(surface);
+            SDL_FreeSurface(surface);
+
+            auto is_inside = [&] (int x, int y) {
+                return x >= 0 && y >= 0 && x < sw && y < sh && inside[y * sw + x];
+            };
+
+            // Brute force search for the nearest opposite pixel. This only
+            // runs when there is no cache, and spread is small.
+            Glyph glyph{0, 0, sw + 2 * spread, sh + 2 * spread, left, top, advance};
+            std::vector<uint8_t> cell(glyph.w * glyph.h);
+            for (int y = 0; y < glyph.h; ++y) {
+                for (int x = 0; x < glyph.w; ++x) {
+                    int gx = x - spread;
+                    int gy = y - spread;
+                    bool here = is_inside(gx, gy);
+
+                    float nearest = float(spread);
+                    for (int dy = -spread; dy <= spread; ++dy) {
+                        for (int dx = -spread; dx <= spread; ++dx) {
+                            if (is_inside(gx + dx, gy + dy) != here) {
+                                nearest = std::min(nearest, std::sqrt(float(dx * dx + dy * dy)));
+                            }
+                        }
+                    }
+
+                    // The edge lies half way between the two pixels.
+                    float distance = (nearest - 0.5f) / float(spread);
+                    float value = 128.0f + (here ? distance : -distance) * 127.0f;
+                    cell[y * glyph.w + x] = (uint8_t)std::max(0.0f, std::min(255.0f, value));
+                }
+            }
+
+            glyphs[code_point] = glyph;
+            cells[code_point] = std::move(cell);
+        }
+    }
+
+    TTF_CloseFont(font);
+
+    if (glyphs.empty()) {
+        LOG(ERROR) << "No glyphs found in font \"" << filename << "\".";
+        throw FontAtlas::LoadException("No glyphs found in font");
+    }
+
+    // Pack the glyphs into rows.
+    int pen_x = 0;
+    int pen_y = 0;
+    int row_height = 0;
+    for (auto &entry : glyphs) {
+        Glyph &glyph = entry.second;
+        if (pen_x + glyph.w > atlas_width) {
+            pen_x = 0;
+            pen_y += row_height;
+            row_height = 0;
+        }
+        glyph.x = pen_x;
+        glyph.y = pen_y;
+        pen_x += glyph.w;
+        row_height = std::max(row_height, glyph.h);
+    }
+
+    // GL ES only handles power of two textures well.
+    field_width = atlas_width;
+    field_height = 1;
+    while (field_height < pen_y + row_height) {
+        field_height *= 2;
+    }
+
+    field.assign(field_width * field_height, 0);
+    for (auto &entry : glyphs) {
+        const Glyph &glyph = entry.second;
+        const std::vector<uint8_t> &cell = cells[entry.first];
+        for (int y = 0; y < glyph.h; ++y) {
+            std::copy(cell.begin() + y * glyph.w,
+                      cell.begin() + (y + 1) * glyph.w,
+                      field.begin() + (glyph.y + y) * field_width + glyph.x);
+        }
+    }
+
+    LOG(INFO) << "Generated font atlas with " << glyphs.size() << " glyphs.";
+}
+
+
+bool FontAtlas::load_cache(const std::string filename) {
+    std::ifstream file(filename + ".sdf", std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char magic[sizeof(cache_magic)];
+    file.read(magic, sizeof(magic));
+    if (!file || !std::equal(std::begin(magic), std::end(magic), std::begin(cache_magic))) {
+        LOG(INFO) << "Ignoring font atlas cache for \"" << filename << "\" in an old format.";
+        return false;
+    }
+
+    if (read_value<int64_t>(file) != (int64_t)get_modification_time(filename)
+        || read_value<int32_t>(file) != base_size
+        || read_value<int32_t>(file) != spread) {
+        LOG(INFO) << "Ignoring out of date font atlas cache for \"" << filename << "\".";
+        return false;
+    }
+
+    line_height  = read_value<int32_t>(file);
+    field_width  = read_value<int32_t>(file);
+    field_height = read_value<int32_t>(file);
+
+    if (field_width != atlas_width || field_height <= 0 || field_height > max_field_height) {
+        LOG(WARNING) << "Font atlas cache for \"" << filename << "\" has an invalid size.";
+        return false;
+    }
+
+    uint32_t glyph_count = read_value<uint32_t>(file);
+    for (uint32_t i = 0; i < glyph_count && file; ++i) {
+        uint32_t code_point = read_value<uint32_t>(file);
+        Glyph glyph;
+        glyph.x       = read_value<int32_t>(file);
+        glyph.y       = read_value<int32_t>(file);
+        glyph.w       = read_value<int32_t>(file);
+        glyph.h       = read_value<int32_t>(file);
+        glyph.left    = read_value<int32_t>(file);
+        glyph.top     = read_value<int32_t>(file);
+        glyph.advance = read_value<int32_t>(file);
+
+        if (glyph.x < 0 || glyph.y < 0 || glyph.w <= 0 || glyph.h <= 0
+            || glyph.w > field_width - glyph.x || glyph.h > field_height - glyph.y) {
+            LOG(WARNING) << "Font atlas cache for \"" << filename << "\" has a glyph outside the atlas.";
+            glyphs.clear();
+            return false;
+        }
+        glyphs[code_point] = glyph;
+    }
+
+    if (file) {
+        field.resize(field_width * field_height);
+        file.read(reinterpret_cast<char *>(field.data()), field.size());
+    }
+
+    if (!file || glyphs.empty()) {
+        LOG(WARNING) << "Font atlas cache for \"" << filename << "\" is truncated.";
+        glyphs.clear();
+        field.clear();
+        return false;
+    }
+
+    VLOG(1) << "Loaded font atlas for \"" << filename << "\" from cache.";
+    return true;
+}
+
+
+void FontAtlas::save_cache(const std::string filename) {
+    // Written to a temporary file and renamed, so a crash or another
+    // instance of the game never sees a half written cache.
+    std::string cache_filename(filename + ".sdf");
+    std::string temporary_filename(cache_filename + ".tmp");
+    std::ofstream file(temporary_filename, std::ios::binary | std::ios::trunc);
+
+    file.write(cache_magic, sizeof(cache_magic));
+    write_value<int64_t>(file, (int64_t)get_modification_time(filename));
+    write_value<int32_t>(file, base_size);
+    write_value<int32_t>(file, spread);
+    write_value<int32_t>(file, line_height);
+    write_value<int32_t>(file, field_width);
+    write_value<int32_t>(file, field_height);
+
+    write_value<uint32_t>(file, (uint32_t)glyphs.size());
+    for (auto &entry : glyphs) {
+        write_value<uint32_t>(file, entry.first);
+        write_value<int32_t>(file, entry.second.x);
+        write_value<int32_t>(file, entry.second.y);
+        write_value<int32_t>(file, entry.second.w);
+        write_value<int32_t>(file, entry.second.h);
+        write_value<int32_t>(file, entry.second.left);
+        write_value<int32_t>(file, entry.second.top);
+        write_value<int32_t>(file, entry.second.advance);
+    }
+
+    file.write(reinterpret_cast<const char *>(field.data()), field.size());
+    file.close();
+
+    // Not fatal: the atlas will just be generated again next time.
+    if (!file || std::rename(temporary_filename.c_str(), cache_filename.c_str()) != 0) {
+        LOG(WARNING) << "Unable to save font atlas cache for \"" << filename << "\".";
+        std::remove(temporary_filename.c_str());
+    }
+}
+
+
+const FontAtlas::Glyph &FontAtlas::get_glyph(uint32_t code_point) const {
+    auto glyph = glyphs.find(code_point);
+    if (glyph == std::end(glyphs)) {
+        glyph = glyphs.find('?');
+    }
+    if (glyph == std::end(glyphs)) {
+        glyph = std::begin(glyphs);
+    }
+    return glyph->second;
+}
+
+int FontAtlas::get_width(const char *text, float scale) const {
+    int advance = 0;
+    while (*text != '\0') {
+        advance += get_glyph(next_code_point(text)).advance;
+    }
+    return (int)std::ceil(float(advance) * scale);
+}
+
+
+uint32_t FontAtlas::next_code_point(const char *&text) {
+    uint8_t lead = (uint8_t)*text++;
+
+    // The number of bits in the first byte set to 1 before the first
+    // zero indicate the total number of bytes in the character.
+    int continuation_bytes;
+    uint32_t code_point;
+    if (lead < 0x80) {
+        return lead;
+    } else if ((lead & 0xe0) == 0xc0) {
+        continuation_bytes = 1;
+        code_point = lead & 0x1f;
+    } else if ((lead & 0xf0) == 0xe0) {
+        continuation_bytes = 2;
+        code_point = lead & 0x0f;
+    } else if ((lead & 0xf8) == 0xf0) {
+        continuation_bytes = 3;
+        code_point = lead & 0x07;
+    } else {
+        return '?';
+    }
+
+    for (; continuation_bytes > 0; --continuation_bytes) {
+        if ((*text & 0xc0) != 0x80) {
+            return '?';
+        }
+        code_point = (code_point << 6) | (*text++ & 0x3f);
+    }
+
+    return code_point;
+}
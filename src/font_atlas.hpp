@@ -0,0 +1,187 @@
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "open_gl.hpp"
+
+#include "cacheable_resource.hpp"
+
+template <typename Res>
+class ResourceCache;
+
+
+
+///
+/// Signed distance field glyph atlas for a typeface.
+///
+/// The glyphs are rasterised once at base_size, and each pixel stores
+/// the distance to the nearest glyph edge rather than coverage. Text of
+/// any size can then be drawn from the same texture by scaling the
+/// quads and thresholding the distance in the text shader, so changing
+/// font size or window resolution never rasterises anything again.
+///
+/// The distance field is saved next to the ttf file (with an added
+/// ".sdf" extension) and reused until the ttf file changes.
+///
+/// The resource name is the path of the ttf file.
+///
+class FontAtlas : public CacheableResource<FontAtlas> {
+private:
+    friend class CacheableResource<FontAtlas>;
+    friend class ResourceCache<FontAtlas>;
+
+public:
+    ///
+    /// Position and metrics of a glyph, in base_size pixels.
+    ///
+    /// The cell includes the spread on every side, and its top-left
+    /// is spread pixels up and left of (left, top), which is relative
+    /// to the pen position at the top of the line.
+    ///
+    struct Glyph {
+        int x;
+        int y;
+        int w;
+        int h;
+        int left;
+        int top;
+        int advance;
+    };
+
+    ///
+    /// Size, in pixels, that the glyphs are rasterised at.
+    ///
+    static const int base_size = 48;
+
+    ///
+    /// Largest distance, in base_size pixels, stored in the field.
+    ///
+    /// This bounds how blurry the edges can be drawn and how far the
+    /// glyphs can be scaled down before they alias.
+    ///
+    static const int spread = 6;
+
+private:
+    ///
+    /// Width of the atlas, in pixels. Glyphs are packed into rows.
+    ///
+    static const int atlas_width = 512;
+
+    ///
+    /// Glyphs by code point.
+    ///
+    std::map<uint32_t, Glyph> glyphs;
+
+    ///
+    /// Distance field, one byte per pixel. 128 is the glyph edge, and
+    /// larger values are inside.
+    ///
+    std::vector<uint8_t> field;
+
+    int field_width;
+    int field_height;
+
+    ///
+    /// Line height, in base_size pixels.
+    ///
+    int line_height;
+
+    ///
+    /// The GL texture id.
+    ///
+    GLuint gl_texture;
+
+    ///
+    /// Rasterise the glyphs and compute the distance field.
+    ///
+    void generate(const std::string filename);
+
+    ///
+    /// Load the distance field from the cache file.
+    ///
+    /// @param filename Path of the ttf file.
+    /// @return Whether an up-to-date cache was loaded.
+    ///
+    bool load_cache(const std::string filename);
+
+    ///
+    /// Save the distance field to the cache file.
+    ///
+    /// @param filename Path of the ttf file.
+    ///
+    void save_cache(const std::string filename);
+
+    ///
+    /// Create a new shared atlas from a resource name.
+    ///
+    /// @param resource_name Path of the ttf file.
+    /// @return A shared pointer to the relevant FontAtlas.
+    ///
+    static std::shared_ptr<FontAtlas> new_resource(const std::string resource_name);
+
+public:
+    ///
+    /// Represents a failure when loading the atlas.
+    ///
+    class LoadException: public std::runtime_error {
+    public:
+        LoadException(const char *message);
+        LoadException(const std::string &message);
+    };
+
+    ///
+    /// Load the atlas of a typeface, generating it if it has not been
+    /// cached, and upload it to the current GL context.
+    ///
+    /// @param filename Path of the ttf file.
+    ///
+    FontAtlas(const std::string filename);
+    ~FontAtlas();
+
+    ///
+    /// Find the glyph for a code point.
+    ///
+    /// Characters which are not in the atlas are drawn as '?'.
+    ///
+    const Glyph &get_glyph(uint32_t code_point) const;
+
+    ///
+    /// Measure a UTF-8 string.
+    ///
+    /// @param text Null-terminated UTF-8 text.
+    /// @param scale Ratio of the wanted font size to base_size.
+    /// @return The width, in pixels, at the given scale.
+    ///
+    int get_width(const char *text, float scale) const;
+
+    ///
+    /// Get the line height, in base_size pixels.
+    ///
+    int get_line_height() const { return line_height; }
+
+    int get_width() const { return field_width; }
+    int get_height() const { return field_height; }
+
+    ///
+    /// Return the GL texture id.
+    ///
+    GLuint get_gl_texture() const { return gl_texture; }
+
+    ///
+    /// Decode one UTF-8 character.
+    ///
+    /// @param text Position in the text, moved past the character.
+    /// @return The code point, or '?' for malformed input.
+    ///
+    static uint32_t next_code_point(const char *&text);
+};
+
+
+
+#endif
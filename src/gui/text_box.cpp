@@ -1,8 +1,11 @@
+#include <algorithm>
 #include <functional>
 #include <cctype>
 #include <glog/logging.h>
 #include <ostream>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "text_box.hpp"
 
@@ -14,11 +17,18 @@
 #include "text_font.hpp"
 #include "texture_atlas.hpp"
 
-TextBox::TextBox(TextBoxType _type) {
+//right trim the string
+static std::string trim_message(std::string part) {
+    part.erase(std::find_if(part.rbegin(), part.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), part.end());
+    return part;
+}
+
+TextBox::TextBox(TextBoxType _type):
+    font(Engine::get_game_font())
+{
 
     type = _type;
     buffer_size = 100;
-    TextFont buttonfont = Engine::get_game_font();
 
     //build forwards button
     forward_button = std::make_shared<Button>(ButtonType::Single);
@@ -203,10 +213,7 @@ void TextBox::traverse_text(Direction direction) {
 }
 
 void TextBox::add_message(std::string part) {
-    //right trim the string
-    part.erase(std::find_if(part.rbegin(), part.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), part.end());
-
-    text_stack.add_new(part);
+    text_stack.add_new(trim_message(part));
 }
 
 
@@ -254,6 +261,14 @@ void TextBox::hide_buttons(){
 
 void TextBox::add_text(std::string text){
 
+    for(std::string part : paginate(text)){
+        this->add_message(part);
+    }
+}
+
+std::vector<std::string> TextBox::paginate(std::string text){
+
+    std::vector<std::string> pages;
     for(unsigned int i=0; i <text.length(); i += buffer_size){
         std::string part = text.substr(i, buffer_size);
 
@@ -267,8 +282,33 @@ void TextBox::add_text(std::string text){
             part = part + "...";
         }
 
-        this->add_message(part);
+        pages.push_back(part);
     }
+    return pages;
+}
+
+void TextBox::prerender(std::string page){
+    page = trim_message(page);
+    if(prerendered_pages.count(page)){
+        return;
+    }
+
+    //The page can only be laid out once the box has been sized,
+    //which happens the first time it is displayed
+    std::pair<int,int> size = get_text()->get_size();
+    if(size.first == 0 || size.second == 0){
+        return;
+    }
+
+    if(prerendered_pages.size() >= max_prerendered_pages){
+        prerendered_pages.clear();
+    }
+
+    std::shared_ptr<Text> new_text = std::make_shared<Text>(Engine::get_game_window(), font, true);
+    new_text->set_text(page);
+    new_text->resize(size.first, size.second);
+    new_text->prerender();
+    prerendered_pages[page] = new_text;
 }
 
 void TextBox::clear_text() {
@@ -278,7 +318,12 @@ void TextBox::clear_text() {
 }
 
 void TextBox::set_text(std::string _text) {
-    TextFont font = Engine::get_game_font();
+    auto prerendered = prerendered_pages.find(_text);
+    if(prerendered != prerendered_pages.end()){
+        text->set_text(prerendered->second);
+        prerendered_pages.erase(prerendered);
+        return;
+    }
 
     std::shared_ptr<Text> new_text = std::make_shared<Text>(Engine::get_game_window(), font, true);
     new_text->set_text(_text);
@@ -1,12 +1,15 @@
 #ifndef TEXT_BOX_H
 #define TEXT_BOX_H
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "component_group.hpp"
 #include "button.hpp"
 #include "lifeline.hpp"
+#include "text_font.hpp"
 #include "text_stack.hpp"
 
 class Text;
@@ -25,6 +28,21 @@ private:
 
     Lifeline text_box;
 
+    ///
+    /// The font for the text, opened once rather than for every page
+    ///
+    TextFont font;
+
+    ///
+    /// Pages which have been rendered ahead of being shown, by their text
+    ///
+    std::map<std::string, std::shared_ptr<Text>> prerendered_pages;
+
+    ///
+    /// Most pages to keep rendered, in case a conversation is abandoned
+    ///
+    static const unsigned int max_prerendered_pages = 32;
+
     void move_text(Direction direction);
     TextBoxType type;
     unsigned int buffer_size;
@@ -52,6 +70,20 @@ public:
     /// the functioin breaks it down into many messages
     void add_text(std::string text_to_display);
 
+    ///
+    /// Split text into the pages add_text would show it as
+    /// @param text_to_display the text to split
+    /// @return the pages, in order
+    ///
+    std::vector<std::string> paginate(std::string text_to_display);
+
+    ///
+    /// Render a page before it is added, so that showing it later
+    /// doesn't stall the frame
+    /// @param page a page returned by paginate
+    ///
+    void prerender(std::string page);
+
     std::shared_ptr<Text> get_text();
     void resize_text(float width, float height);
     void move_text(float x_offset, float y_offset);
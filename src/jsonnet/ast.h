@@ -20,8 +20,11 @@ limitations under the License.
 #include <cstdlib>
 
 #include <iostream>
+#include <list>
 #include <string>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "lexer.h"
@@ -72,8 +75,10 @@ struct AST {
     LocationRange location;
     ASTType type;
     std::vector<const Identifier *> freeVariables;
+    /** Whether static analysis has initialized freeVariables, so it is not done again. */
+    bool analysed;
     AST(const LocationRange &location, ASTType type)
-      : location(location), type(type)
+      : location(location), type(type), analysed(false)
     {
     }
     virtual ~AST(void)
@@ -368,29 +373,36 @@ struct Var : public AST {
 
 
 /** Allocates ASTs on demand, frees them in its destructor.
+ *
+ * Thread safe, so that interpreters on several threads can share the ASTs and identifiers.
  */
 class Allocator {
-    std::map<std::string, const Identifier*> internedIdentifiers;
+    std::mutex mutex;
+    /** The keys point to the names of the identifiers themselves, which never move. */
+    std::unordered_map<StringSlice, const Identifier*, StringSliceHash> internedIdentifiers;
     std::vector<AST*> allocated;
     public:
     template <class T, class... Args> T* make(Args... args)
     {
         auto r = new T(args...);
+        std::lock_guard<std::mutex> lock(mutex);
         allocated.push_back(r);
         return r;
     }
     /** Returns interned identifiers.
      *
-     * The location used in the Identifier AST is that of the first one parsed.
+     * The name is only copied the first time it is seen, so the parser can pass the text of a
+     * token straight from the input.
      */
-    const Identifier *makeIdentifier(const std::string &name)
+    const Identifier *makeIdentifier(const StringSlice &name)
     {
+        std::lock_guard<std::mutex> lock(mutex);
         auto it = internedIdentifiers.find(name);
         if (it != internedIdentifiers.end()) {
             return it->second;
         }
-        auto r = new Identifier(name);
-        internedIdentifiers[name] = r;
+        auto r = new Identifier(name.str());
+        internedIdentifiers[StringSlice(r->name)] = r;
         return r;
     }
     ~Allocator()
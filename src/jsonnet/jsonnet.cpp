@@ -169,6 +169,7 @@ void usage(std::ostream &o)
     o << "  -V / --var <var>=<val>  Specify an 'external' var to the given value\n";
     o << "  -E / --env <var>        Bring in an environment var as an 'external' var\n";
     o << "  -m / --multi            Write multiple files, list files on stdout\n";
+    o << "  --max-threads <n>       Number of threads to write multiple files with\n";
     o << "  -S / --string           Expect a string, manifest as plain text\n";
     o << "  -s / --max-stack <n>    Number of allowed stack frames\n";
     o << "  -t / --max-trace <n>    Max length of stack trace before cropping\n";
@@ -264,6 +265,14 @@ int main(int argc, const char **argv)
                     return EXIT_FAILURE;
                 }
                 jsonnet_gc_min_objects(vm, l);
+            } else if (arg == "--max-threads") {
+                long l = strtol_check(next_arg(i, args));
+                if (l < 1) {
+                    std::cerr << "ERROR: Invalid --max-threads value: " << l << std::endl;
+                    usage(std::cerr);
+                    return EXIT_FAILURE;
+                }
+                jsonnet_max_threads(vm, l);
             } else if (arg == "-t" || arg == "--max-trace") {
                 long l = strtol_check(next_arg(i, args));
                 if (l < 0) {
@@ -57,7 +57,8 @@ static bool is_symbol(char c)
     return false;
 }
 
-std::string lex_number(const char *&c, const std::string &filename, const Location &begin)
+/** Advance c to the last char of the number it is on. */
+static void lex_number(const char *&c, const std::string &filename, const Location &begin)
 {
     // This function should be understood with reference to the linked image:
     // http://www.json.org/number.gif
@@ -78,8 +79,6 @@ std::string lex_number(const char *&c, const std::string &filename, const Locati
         AFTER_EXP_DIGIT
     } state;
 
-    std::string r;
-
     state = BEGIN;
     while (true) {
         switch (state) {
@@ -211,27 +210,27 @@ std::string lex_number(const char *&c, const std::string &filename, const Locati
             }
             break;
         }
-        r += *c;
         c++;
     }
     end:
     c--;
-    return r;
 }
 
-std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
+Tokens jsonnet_lex(const std::string &filename, const char *input)
 {
     unsigned long line_number = 1;
     const char *line_start = input;
 
-    std::list<Token> r;
+    Tokens r;
 
     const char *c = input;
 
     for ( ; *c!='\0' ; ++c) {
         Location begin(line_number, c - line_start + 1);
         Token::Kind kind;
-        std::string data;
+        // The text of the token is usually the chars from lexeme to c.
+        const char *lexeme = c;
+        StringSlice data;
 
         switch (*c) {
 
@@ -294,37 +293,32 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
             kind = Token::OPERATOR;
             if (*(c+1) == '=') {
                 c++;
-                data = "!=";
-            } else {
-                data = "!";
             }
+            data = StringSlice(lexeme, c - lexeme + 1);
             break;
 
             case '~':
-            kind = Token::OPERATOR;
-            data = "~";
-            break;
-
             case '+':
-            kind = Token::OPERATOR;
-            data = "+";
-
-            break;
             case '-':
             kind = Token::OPERATOR;
-            data = "-";
+            data = StringSlice(lexeme, 1);
             break;
 
             // Numeric literals.
             case '0': case '1': case '2': case '3': case '4':
             case '5': case '6': case '7': case '8': case '9':
             kind = Token::NUMBER;
-            data = lex_number(c, filename, begin);
+            lex_number(c, filename, begin);
+            data = StringSlice(lexeme, c - lexeme + 1);
             break;
 
-            // String literals.
+            // String literals.  Until an escape is found, the text is the chars between the
+            // quotes.  After that it is built up in unescaped.
             case '"': {
                 c++;
+                const char *text = c;
+                std::string unescaped;
+                bool escaped = false;
                 for (; ; ++c) {
                     if (*c == '\0') {
                         throw StaticError(filename, begin, "Unterminated string");
@@ -334,37 +328,41 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
                     }
                     switch (*c) {
                         case '\\':
+                        if (!escaped) {
+                            unescaped.assign(text, c);
+                            escaped = true;
+                        }
                         switch (*(++c)) {
                             case '"':
-                            data += *c;
+                            unescaped += *c;
                             break;
 
                             case '\\':
-                            data += *c;
+                            unescaped += *c;
                             break;
 
                             case '/':
-                            data += *c;
+                            unescaped += *c;
                             break;
 
                             case 'b':
-                            data += '\b';
+                            unescaped += '\b';
                             break;
 
                             case 'f':
-                            data += '\f';
+                            unescaped += '\f';
                             break;
 
                             case 'n':
-                            data += '\n';
+                            unescaped += '\n';
                             break;
 
                             case 'r':
-                            data += '\r';
+                            unescaped += '\r';
                             break;
 
                             case 't':
-                            data += '\t';
+                            unescaped += '\t';
                             break;
 
                             case 'u': {
@@ -399,19 +397,19 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
 
                                 // Encode in UTF-8.
                                 if (codepoint < 0x0080) {
-                                    data += codepoint;
+                                    unescaped += codepoint;
                                 } else {
                                     auto msg = "Codepoint out of ascii range.";
                                     throw StaticError(filename, begin, msg);
                                 }
 /*
                                 } else if (codepoint < 0x0800) {
-                                    data += 0xC0 | (codepoint >> 6);
-                                    data += 0x80 | (codepoint & 0x3F);
+                                    unescaped += 0xC0 | (codepoint >> 6);
+                                    unescaped += 0x80 | (codepoint & 0x3F);
                                 } else {
-                                    data += 0xE0 | (codepoint >> 12);
-                                    data += 0x80 | ((codepoint >> 6) & 0x3F);
-                                    data += 0x80 | (codepoint & 0x3F);
+                                    unescaped += 0xE0 | (codepoint >> 12);
+                                    unescaped += 0x80 | ((codepoint >> 6) & 0x3F);
+                                    unescaped += 0x80 | (codepoint & 0x3F);
                                 }
 */
                                 // Leave us on the last char, ready for the ++c at
@@ -437,14 +435,20 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
                         case '\n':
                         line_number++;
                         line_start = c+1;
-                        data += *c;
+                        if (escaped) unescaped += *c;
                         break;
 
                         default:
                         // Just a regular letter.
-                        data += *c;
+                        if (escaped) unescaped += *c;
                     }
                 }
+                if (escaped) {
+                    r.unescaped.push_back(std::move(unescaped));
+                    data = StringSlice(r.unescaped.back());
+                } else {
+                    data = StringSlice(text, c - text);
+                }
                 kind = Token::STRING;
             }
             break;
@@ -452,14 +456,13 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
             // Keywords
             default:
             if (is_identifier_first(*c)) {
-                std::string id;
                 for (; *c != '\0' ; ++c) {
                     if (!is_identifier(*c)) {
                         break;
                     }
-                    id += *c;
                 }
                 --c;
+                StringSlice id(lexeme, c - lexeme + 1);
                 if (id == "else") {
                     kind = Token::ELSE;
                 } else if (id == "error") {
@@ -545,9 +548,9 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
                     if (!is_symbol(*c)) {
                         break;
                     }
-                    data += *c;
                 }
                 --c;
+                data = StringSlice(lexeme, c - lexeme + 1);
                 kind = Token::OPERATOR;
             } else {
                 std::stringstream ss;
@@ -562,11 +565,11 @@ std::list<Token> jsonnet_lex(const std::string &filename, const char *input)
         }
 
         Location end(line_number, c - line_start + 1);
-        r.push_back(Token(kind, data, LocationRange(filename, begin, end)));
+        r.tokens.emplace_back(kind, data, &filename, begin, end);
     }
 
     Location end(line_number, c - line_start + 1);
-    r.push_back(Token(Token::END_OF_FILE, "", LocationRange(filename, end, end)));
+    r.tokens.emplace_back(Token::END_OF_FILE, StringSlice(), &filename, end, end);
     return r;
 }
 
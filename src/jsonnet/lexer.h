@@ -18,13 +18,69 @@ limitations under the License.
 #define JSONNET_LEXER_H
 
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <string>
-#include <list>
 #include <sstream>
+#include <vector>
 
 #include "static_error.h"
 
+/** Part of a string that is held somewhere else, such as a lexeme in the input being lexed.
+ *
+ * Whatever holds the chars must outlive the slice.
+ */
+struct StringSlice {
+    const char *data;
+    size_t length;
+    StringSlice(void)
+      : data(""), length(0)
+    { }
+    StringSlice(const char *data, size_t length)
+      : data(data), length(length)
+    { }
+    StringSlice(const char *str)
+      : data(str), length(std::strlen(str))
+    { }
+    StringSlice(const std::string &str)
+      : data(str.data()), length(str.length())
+    { }
+    std::string str(void) const
+    {
+        return std::string(data, length);
+    }
+};
+
+static inline bool operator==(const StringSlice &a, const StringSlice &b)
+{
+    return a.length == b.length && std::memcmp(a.data, b.data, a.length) == 0;
+}
+
+static inline bool operator!=(const StringSlice &a, const StringSlice &b)
+{
+    return !(a == b);
+}
+
+static inline std::ostream &operator<<(std::ostream &o, const StringSlice &s)
+{
+    o.write(s.data, s.length);
+    return o;
+}
+
+/** FNV-1a hash of the chars in a slice, for hash tables keyed by StringSlice. */
+struct StringSliceHash {
+    size_t operator()(const StringSlice &s) const
+    {
+        size_t h = 2166136261u;
+        for (size_t i = 0 ; i < s.length ; ++i) {
+            h ^= (unsigned char)(s.data[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+};
+
 struct Token {
     enum Kind {
         // Symbols
@@ -68,15 +124,27 @@ struct Token {
         END_OF_FILE
     } kind;
 
-    std::string data;
+    /** The text of an IDENTIFIER, NUMBER, OPERATOR, or STRING (with its escapes replaced), and
+     * empty for other tokens.
+     */
+    StringSlice data;
+
+    /** The file the token was lexed from.  Tokens only point to it, as few of them end up in a
+     * LocationRange.
+     */
+    const std::string *file;
 
-    LocationRange location;
+    Location begin, end;
 
-    Token(Kind kind, const std::string &data, const LocationRange &location)
-      : kind(kind), data(data), location(location)
+    Token(Kind kind, const StringSlice &data, const std::string *file,
+          const Location &begin, const Location &end)
+      : kind(kind), data(data), file(file), begin(begin), end(end)
     { }
 
-    Token(Kind kind, const std::string &data="") : kind(kind), data(data) { }
+    LocationRange location(void) const
+    {
+        return LocationRange(*file, begin, end);
+    }
 
     static const char *toString(Kind v)
     {
@@ -139,7 +207,7 @@ static inline std::ostream &operator<<(std::ostream &o, Token::Kind v)
 
 static inline std::ostream &operator<<(std::ostream &o, const Token &v)
 {
-    if (v.data == "") {
+    if (v.data.length == 0) {
         o << Token::toString(v.kind);
     } else if (v.kind == Token::OPERATOR) {
             o << "\"" << v.data << "\"";
@@ -149,6 +217,18 @@ static inline std::ostream &operator<<(std::ostream &o, const Token &v)
     return o;
 }
 
-std::list<Token> jsonnet_lex(const std::string &filename, const char *input);
+/** The tokens lexed from an input.
+ *
+ * The tokens' text points into the input, and their locations to the filename, so both must outlive
+ * them.  Only strings whose escapes have been replaced have text of their own, in unescaped.
+ */
+struct Tokens {
+    std::vector<Token> tokens;
+
+    /** The text of STRING tokens that had escapes.  A deque so that it never moves. */
+    std::deque<std::string> unescaped;
+};
+
+Tokens jsonnet_lex(const std::string &filename, const char *input);
 
 #endif
@@ -20,9 +20,13 @@ limitations under the License.
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 
+#include <sys/stat.h>
+
 extern "C" {
     #include "libjsonnet.h"
 }
@@ -44,6 +48,19 @@ static char *from_string(JsonnetVm* vm, const std::string &v)
     return r;
 }
 
+/** A file loaded by default_import_callback. */
+struct LoadedFile {
+    struct timespec mtime;
+    off_t size;
+    std::string content;
+};
+
+/** Files loaded by default_import_callback, by path.  A file is only loaded again once its size or
+ * modification time changes, so evaluations that import the same libraries don't read them again.
+ */
+static std::mutex loaded_files_mutex;
+static std::map<std::string, LoadedFile> loaded_files;
+
 /** Resolve the absolute path and use C++ file io to load the file.
  */
 static char *default_import_callback(void *ctx, const char *base, const char *file, int *success)
@@ -67,6 +84,19 @@ static char *default_import_callback(void *ctx, const char *base, const char *fi
     else
         abs_path = std::string(base) + file;
 
+    struct stat st;
+    bool regular = ::stat(abs_path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    if (regular) {
+        std::lock_guard<std::mutex> lock(loaded_files_mutex);
+        auto it = loaded_files.find(abs_path);
+        if (it != loaded_files.end() && it->second.size == st.st_size
+            && it->second.mtime.tv_sec == st.st_mtim.tv_sec
+            && it->second.mtime.tv_nsec == st.st_mtim.tv_nsec) {
+            *success = 1;
+            return from_string(vm, it->second.content);
+        }
+    }
+
     std::ifstream f;
     f.open(abs_path.c_str());
     if (!f.good()) {
@@ -76,6 +106,12 @@ static char *default_import_callback(void *ctx, const char *base, const char *fi
     try {
         std::string input;
         input.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        if (regular) {
+            // The file was looked at before it was read, so if it changes while being read, it
+            // will be read again next time.
+            std::lock_guard<std::mutex> lock(loaded_files_mutex);
+            loaded_files[abs_path] = LoadedFile{st.st_mtim, st.st_size, input};
+        }
         *success = 1;
         return from_string(vm, input);
     } catch (const std::ios_base::failure &io_err) {
@@ -95,9 +131,11 @@ struct JsonnetVm {
     JsonnetImportCallback *importCallback;
     void *importCallbackContext;
     bool stringOutput;
+    unsigned maxThreads;
     JsonnetVm(void)
       : gcGrowthTrigger(2.0), maxStack(500), gcMinObjects(1000), debugAst(false), maxTrace(20),
-        importCallback(default_import_callback), importCallbackContext(this), stringOutput(false)
+        importCallback(default_import_callback), importCallbackContext(this), stringOutput(false),
+        maxThreads(1)
     { }
 };
 
@@ -146,6 +184,11 @@ void jsonnet_gc_growth_trigger(JsonnetVm *vm, double v)
     vm->gcGrowthTrigger = v;
 }
 
+void jsonnet_max_threads(struct JsonnetVm *vm, unsigned v)
+{
+    vm->maxThreads = v;
+}
+
 void jsonnet_string_output(struct JsonnetVm *vm, int v)
 {
     vm->stringOutput = bool(v);
@@ -172,8 +215,15 @@ void jsonnet_max_trace(JsonnetVm *vm, unsigned v)
     vm->maxTrace = v;
 }
 
+/** Evaluate a snippet.
+ *
+ * \param output If not null, the JSON is passed to this rather than returned.
+ * \param visitor If not null, the value is passed to this rather than returned as JSON.
+ */
 static char *jsonnet_evaluate_snippet_aux(JsonnetVm *vm, const char *filename,
-                                          const char *snippet, int *error, bool multi)
+                                          const char *snippet, int *error, bool multi,
+                                          JsonnetOutputCallback *output, void *output_ctx,
+                                          const JsonnetJsonVisitor *visitor, void *visitor_ctx)
 {
     try {
         Allocator alloc;
@@ -184,11 +234,21 @@ static char *jsonnet_evaluate_snippet_aux(JsonnetVm *vm, const char *filename,
             json_str = jsonnet_unparse_jsonnet(expr);
         } else {
             jsonnet_static_analysis(expr);
-            if (multi) {
+            if (visitor != nullptr) {
+                jsonnet_vm_execute_visit(&alloc, expr, vm->extVars, vm->maxStack,
+                                         vm->gcMinObjects, vm->gcGrowthTrigger,
+                                         vm->importCallback, vm->importCallbackContext,
+                                         vm->stringOutput, *visitor, visitor_ctx);
+            } else if (output != nullptr) {
+                jsonnet_vm_execute_stream(&alloc, expr, vm->extVars, vm->maxStack,
+                                          vm->gcMinObjects, vm->gcGrowthTrigger,
+                                          vm->importCallback, vm->importCallbackContext,
+                                          vm->stringOutput, output, output_ctx);
+            } else if (multi) {
                 files = jsonnet_vm_execute_multi(&alloc, expr, vm->extVars, vm->maxStack,
                                                  vm->gcMinObjects, vm->gcGrowthTrigger,
                                                  vm->importCallback, vm->importCallbackContext,
-                                                 vm->stringOutput);
+                                                 vm->stringOutput, vm->maxThreads);
             } else {
                 json_str = jsonnet_vm_execute(&alloc, expr, vm->extVars, vm->maxStack,
                                               vm->gcMinObjects, vm->gcGrowthTrigger,
@@ -218,6 +278,21 @@ static char *jsonnet_evaluate_snippet_aux(JsonnetVm *vm, const char *filename,
             buf[i] = '\0'; // final sentinel
             *error = false;
             return buf;
+        } else if (visitor != nullptr) {
+            if (vm->debugAst) {
+                *error = true;
+                return from_string(vm, "Cannot visit the AST, it is not a value.\n");
+            }
+            *error = false;
+            return from_string(vm, "");
+        } else if (output != nullptr) {
+            json_str += "\n";
+            if (output(output_ctx, json_str.data(), json_str.length()) != 0) {
+                *error = true;
+                return from_string(vm, "RUNTIME ERROR: Could not write output.\n");
+            }
+            *error = false;
+            return from_string(vm, "");
         } else {
             json_str += "\n";
             *error = false;
@@ -251,7 +326,9 @@ static char *jsonnet_evaluate_snippet_aux(JsonnetVm *vm, const char *filename,
 
 }
 
-static char *jsonnet_evaluate_file_aux(JsonnetVm *vm, const char *filename, int *error, bool multi)
+static char *jsonnet_evaluate_file_aux(JsonnetVm *vm, const char *filename, int *error, bool multi,
+                                       JsonnetOutputCallback *output, void *output_ctx,
+                                       const JsonnetJsonVisitor *visitor, void *visitor_ctx)
 {
     std::ifstream f;
     f.open(filename);
@@ -265,13 +342,15 @@ static char *jsonnet_evaluate_file_aux(JsonnetVm *vm, const char *filename, int
     input.assign(std::istreambuf_iterator<char>(f),
                  std::istreambuf_iterator<char>());
 
-    return jsonnet_evaluate_snippet_aux(vm, filename, input.c_str(), error, multi);
+    return jsonnet_evaluate_snippet_aux(vm, filename, input.c_str(), error, multi,
+                                        output, output_ctx, visitor, visitor_ctx);
 }
 
 char *jsonnet_evaluate_file(JsonnetVm *vm, const char *filename, int *error)
 {
     TRY
-    return jsonnet_evaluate_file_aux(vm, filename, error, false);
+    return jsonnet_evaluate_file_aux(vm, filename, error, false, nullptr, nullptr, nullptr,
+                                     nullptr);
     CATCH("jsonnet_evaluate_file")
     return nullptr;  // Never happens.
 }
@@ -279,7 +358,7 @@ char *jsonnet_evaluate_file(JsonnetVm *vm, const char *filename, int *error)
 char *jsonnet_evaluate_file_multi(JsonnetVm *vm, const char *filename, int *error)
 {
     TRY
-    return jsonnet_evaluate_file_aux(vm, filename, error, true);
+    return jsonnet_evaluate_file_aux(vm, filename, error, true, nullptr, nullptr, nullptr, nullptr);
     CATCH("jsonnet_evaluate_file_multi")
     return nullptr;  // Never happens.
 }
@@ -287,7 +366,8 @@ char *jsonnet_evaluate_file_multi(JsonnetVm *vm, const char *filename, int *erro
 char *jsonnet_evaluate_snippet(JsonnetVm *vm, const char *filename, const char *snippet, int *error)
 {
     TRY
-    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, false);
+    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, false, nullptr, nullptr,
+                                        nullptr, nullptr);
     CATCH("jsonnet_evaluate_snippet")
     return nullptr;  // Never happens.
 }
@@ -296,11 +376,50 @@ char *jsonnet_evaluate_snippet_multi(JsonnetVm *vm, const char *filename,
                                      const char *snippet, int *error)
 {
     TRY
-    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, true);
+    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, true, nullptr, nullptr,
+                                        nullptr, nullptr);
     CATCH("jsonnet_evaluate_snippet_multi")
     return nullptr;  // Never happens.
 }
 
+char *jsonnet_evaluate_file_stream(JsonnetVm *vm, const char *filename,
+                                   JsonnetOutputCallback *cb, void *ctx, int *error)
+{
+    TRY
+    return jsonnet_evaluate_file_aux(vm, filename, error, false, cb, ctx, nullptr, nullptr);
+    CATCH("jsonnet_evaluate_file_stream")
+    return nullptr;  // Never happens.
+}
+
+char *jsonnet_evaluate_snippet_stream(JsonnetVm *vm, const char *filename, const char *snippet,
+                                      JsonnetOutputCallback *cb, void *ctx, int *error)
+{
+    TRY
+    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, false, cb, ctx,
+                                        nullptr, nullptr);
+    CATCH("jsonnet_evaluate_snippet_stream")
+    return nullptr;  // Never happens.
+}
+
+char *jsonnet_evaluate_file_visit(JsonnetVm *vm, const char *filename,
+                                  const JsonnetJsonVisitor *visitor, void *ctx, int *error)
+{
+    TRY
+    return jsonnet_evaluate_file_aux(vm, filename, error, false, nullptr, nullptr, visitor, ctx);
+    CATCH("jsonnet_evaluate_file_visit")
+    return nullptr;  // Never happens.
+}
+
+char *jsonnet_evaluate_snippet_visit(JsonnetVm *vm, const char *filename, const char *snippet,
+                                     const JsonnetJsonVisitor *visitor, void *ctx, int *error)
+{
+    TRY
+    return jsonnet_evaluate_snippet_aux(vm, filename, snippet, error, false, nullptr, nullptr,
+                                        visitor, ctx);
+    CATCH("jsonnet_evaluate_snippet_visit")
+    return nullptr;  // Never happens.
+}
+
 char *jsonnet_realloc(JsonnetVm *vm, char *str, size_t sz)
 {
     (void) vm;
@@ -41,12 +41,22 @@ struct JsonnetVm *jsonnet_make(void);
 /** Set the maximum stack depth. */
 void jsonnet_max_stack(struct JsonnetVm *vm, unsigned v);
 
-/** Set the number of objects required before a garbage collection cycle is allowed. */
+/** Set the number of objects to allocate before a garbage collection cycle is allowed. */
 void jsonnet_gc_min_objects(struct JsonnetVm *vm, unsigned v);
 
-/** Run the garbage collector after this amount of growth in the number of objects. */
+/** Collect the whole heap after this amount of growth in the number of objects that survived
+ * earlier cycles.  Other cycles only collect recently allocated objects. */
 void jsonnet_gc_growth_trigger(struct JsonnetVm *vm, double v);
 
+/** Set the number of threads that can be used to manifest files at the same time in
+ * jsonnet_evaluate_file_multi and jsonnet_evaluate_snippet_multi.  The default is 1.
+ *
+ * Each thread evaluates the program again with its own heap, so this helps when the files are
+ * expensive to manifest.  If it is more than 1, the import callback must be safe to call from
+ * several threads at once.
+ */
+void jsonnet_max_threads(struct JsonnetVm *vm, unsigned v);
+
 /** Expect a string as output and don't JSON encode it. */
 void jsonnet_string_output(struct JsonnetVm *vm, int v);
 
@@ -73,6 +83,10 @@ typedef char *JsonnetImportCallback(void *ctx, const char *base, const char *rel
 char *jsonnet_realloc(struct JsonnetVm *vm, char *buf, size_t sz);
 
 /** Override the callback used to locate imports.
+ *
+ * The default callback reads files relative to the importing file, and only reads a file again
+ * once its size or modification time has changed.  Imported Jsonnet is parsed once per process for
+ * each version of a file, so a callback that returns the same content again is cheap to use.
  */
 void jsonnet_import_callback(struct JsonnetVm *vm, JsonnetImportCallback *cb, void *ctx);
 
@@ -142,6 +156,112 @@ char *jsonnet_evaluate_snippet_multi(struct JsonnetVm *vm,
                                      const char *snippet,
                                      int *error);
 
+/** Callback used to receive output as it is produced.
+ *
+ * \param ctx User pointer, given in jsonnet_evaluate_file_stream or
+ * jsonnet_evaluate_snippet_stream.
+ * \param buf The next part of the output.  It is not terminated with \0.
+ * \param len The number of chars in buf.
+ * \returns 0 on success, anything else to stop with an error.
+ */
+typedef int JsonnetOutputCallback(void *ctx, const char *buf, size_t len);
+
+/** Evaluate a file containing Jsonnet code, passing the JSON to a callback as it is produced.
+ *
+ * The JSON is passed in parts, so a large output is never held in memory all at once.  If there is
+ * an error, some of the JSON may already have been passed to the callback.  The returned string
+ * should be cleaned up with jsonnet_realloc.
+ *
+ * \param filename Path to a file containing Jsonnet code.
+ * \param cb Receives the JSON.
+ * \param ctx User pointer passed to cb.
+ * \param error Return by reference whether or not there was an error.
+ * \returns Either an empty string or the error message.
+ */
+char *jsonnet_evaluate_file_stream(struct JsonnetVm *vm,
+                                   const char *filename,
+                                   JsonnetOutputCallback *cb,
+                                   void *ctx,
+                                   int *error);
+
+/** Evaluate a string containing Jsonnet code, passing the JSON to a callback as it is produced.
+ *
+ * \see jsonnet_evaluate_file_stream
+ *
+ * \param filename Path to a file (used in error messages).
+ * \param snippet Jsonnet code to execute.
+ * \param cb Receives the JSON.
+ * \param ctx User pointer passed to cb.
+ * \param error Return by reference whether or not there was an error.
+ * \returns Either an empty string or the error message.
+ */
+char *jsonnet_evaluate_snippet_stream(struct JsonnetVm *vm,
+                                      const char *filename,
+                                      const char *snippet,
+                                      JsonnetOutputCallback *cb,
+                                      void *ctx,
+                                      int *error);
+
+/** Callbacks used to receive output as JSON values rather than text.
+ *
+ * Each value is passed to exactly one of null_value, boolean, number, string, or a matching pair of
+ * array_begin and array_end (with the elements in between) or object_begin and object_end (with
+ * each field's key and then its value in between).  Fields are passed in alphabetical order, and
+ * hidden fields are left out, as in the JSON text.
+ *
+ * Each callback is given the user pointer, and returns 0 on success, anything else to stop with an
+ * error.
+ */
+struct JsonnetJsonVisitor {
+    int (*null_value)(void *ctx);
+    int (*boolean)(void *ctx, int v);
+    int (*number)(void *ctx, double v);
+    /** The string is not terminated with \0, and may contain \0. */
+    int (*string)(void *ctx, const char *v, size_t len);
+    int (*array_begin)(void *ctx);
+    int (*array_end)(void *ctx);
+    int (*object_begin)(void *ctx);
+    /** The key is not terminated with \0, and may contain \0. */
+    int (*object_key)(void *ctx, const char *key, size_t len);
+    int (*object_end)(void *ctx);
+};
+
+/** Evaluate a file containing Jsonnet code, passing the result to a visitor as JSON values.
+ *
+ * This avoids converting the result to JSON text only for the caller to parse it again.  If there
+ * is an error, some of the values may already have been passed to the visitor.  The returned string
+ * should be cleaned up with jsonnet_realloc.
+ *
+ * \param filename Path to a file containing Jsonnet code.
+ * \param visitor Receives the values.
+ * \param ctx User pointer passed to the visitor's callbacks.
+ * \param error Return by reference whether or not there was an error.
+ * \returns Either an empty string or the error message.
+ */
+char *jsonnet_evaluate_file_visit(struct JsonnetVm *vm,
+                                  const char *filename,
+                                  const struct JsonnetJsonVisitor *visitor,
+                                  void *ctx,
+                                  int *error);
+
+/** Evaluate a string containing Jsonnet code, passing the result to a visitor as JSON values.
+ *
+ * \see jsonnet_evaluate_file_visit
+ *
+ * \param filename Path to a file (used in error messages).
+ * \param snippet Jsonnet code to execute.
+ * \param visitor Receives the values.
+ * \param ctx User pointer passed to the visitor's callbacks.
+ * \param error Return by reference whether or not there was an error.
+ * \returns Either an empty string or the error message.
+ */
+char *jsonnet_evaluate_snippet_visit(struct JsonnetVm *vm,
+                                     const char *filename,
+                                     const char *snippet,
+                                     const struct JsonnetJsonVisitor *visitor,
+                                     void *ctx,
+                                     int *error);
+
 /** Complement of \see jsonnet_vm_make. */
 void jsonnet_destroy(struct JsonnetVm *vm);
 
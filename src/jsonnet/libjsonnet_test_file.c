@@ -16,13 +16,184 @@ limitations under the License.
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "libjsonnet.h"
 
+/** Collects streamed output. */
+struct Streamed {
+    struct JsonnetVm *vm;
+    char *buf;
+    size_t len;
+};
+
+static int append(void *ctx, const char *buf, size_t len)
+{
+    struct Streamed *streamed = ctx;
+    streamed->buf = jsonnet_realloc(streamed->vm, streamed->buf, streamed->len + len + 1);
+    memcpy(streamed->buf + streamed->len, buf, len);
+    streamed->len += len;
+    streamed->buf[streamed->len] = '\0';
+    return 0;
+}
+
+/** Writes visited values out again as JSON, laid out as jsonnet lays it out. */
+#define MAX_DEPTH 1000
+struct Rewritten {
+    struct Streamed out;
+    /** How many elements or fields each enclosing array or object has had so far. */
+    unsigned counts[MAX_DEPTH];
+    unsigned depth;
+    /** Whether a key has just been written, so the value needs no indent. */
+    int after_key;
+};
+
+static int write_str(struct Rewritten *r, const char *str)
+{
+    return append(&r->out, str, strlen(str));
+}
+
+static int write_indent(struct Rewritten *r, unsigned depth)
+{
+    unsigned i;
+    for (i = 0 ; i < depth ; ++i) {
+        write_str(r, "   ");
+    }
+    return 0;
+}
+
+/** Write what comes before an array element, object key or the whole value. */
+static int write_prefix(struct Rewritten *r)
+{
+    if (r->after_key) {
+        r->after_key = 0;
+        return 0;
+    }
+    if (r->depth == 0) return 0;
+    write_str(r, r->counts[r->depth - 1]++ == 0 ? "\n" : ",\n");
+    return write_indent(r, r->depth);
+}
+
+static int write_escaped(struct Rewritten *r, const char *str, size_t len)
+{
+    char code[8];
+    size_t i;
+    write_str(r, "\"");
+    for (i = 0 ; i < len ; ++i) {
+        char c = str[i];
+        switch (c) {
+            case '"': write_str(r, "\\\""); break;
+            case '\\': write_str(r, "\\\\"); break;
+            case '\b': write_str(r, "\\b"); break;
+            case '\f': write_str(r, "\\f"); break;
+            case '\n': write_str(r, "\\n"); break;
+            case '\r': write_str(r, "\\r"); break;
+            case '\t': write_str(r, "\\t"); break;
+            default:
+            if (c < 0x20 || c > 0x7e) {
+                sprintf(code, "\\u%04x", (unsigned)(unsigned char)c);
+                write_str(r, code);
+            } else {
+                append(&r->out, &c, 1);
+            }
+        }
+    }
+    return write_str(r, "\"");
+}
+
+static int visit_null(void *ctx)
+{
+    write_prefix(ctx);
+    return write_str(ctx, "null");
+}
+
+static int visit_boolean(void *ctx, int v)
+{
+    write_prefix(ctx);
+    return write_str(ctx, v ? "true" : "false");
+}
+
+static int visit_number(void *ctx, double v)
+{
+    char num[32];
+    if (v == (double)(long long)v) {
+        sprintf(num, "%.0f", v);
+    } else {
+        sprintf(num, "%.17g", v);
+    }
+    write_prefix(ctx);
+    return write_str(ctx, num);
+}
+
+static int visit_string(void *ctx, const char *v, size_t len)
+{
+    write_prefix(ctx);
+    return write_escaped(ctx, v, len);
+}
+
+static int begin(struct Rewritten *r, const char *open)
+{
+    write_prefix(r);
+    if (r->depth == MAX_DEPTH) return 1;
+    r->counts[r->depth++] = 0;
+    return write_str(r, open);
+}
+
+static int end(struct Rewritten *r, const char *close)
+{
+    if (r->counts[--r->depth] == 0) {
+        write_str(r, " ");
+    } else {
+        write_str(r, "\n");
+        write_indent(r, r->depth);
+    }
+    return write_str(r, close);
+}
+
+static int visit_array_begin(void *ctx)
+{
+    return begin(ctx, "[");
+}
+
+static int visit_array_end(void *ctx)
+{
+    return end(ctx, "]");
+}
+
+static int visit_object_begin(void *ctx)
+{
+    return begin(ctx, "{");
+}
+
+static int visit_object_key(void *ctx, const char *key, size_t len)
+{
+    struct Rewritten *r = ctx;
+    write_prefix(r);
+    write_escaped(r, key, len);
+    write_str(r, ": ");
+    r->after_key = 1;
+    return 0;
+}
+
+static int visit_object_end(void *ctx)
+{
+    return end(ctx, "}");
+}
+
+static const struct JsonnetJsonVisitor rewriter = {
+    visit_null, visit_boolean, visit_number, visit_string,
+    visit_array_begin, visit_array_end,
+    visit_object_begin, visit_object_key, visit_object_end
+};
+
 int main(int argc, const char **argv)
 {
     int error;
     char *output;
+    char *stream_error;
+    char *visit_error;
+    struct Streamed streamed;
+    struct Rewritten rewritten;
     struct JsonnetVm *vm;
     if (argc != 2) {
         fprintf(stderr, "libjsonnet_test_file <file>\n");
@@ -36,6 +207,42 @@ int main(int argc, const char **argv)
         jsonnet_destroy(vm);
         return EXIT_FAILURE;
     } 
+
+    /* Streaming the output should give the same JSON. */
+    streamed.vm = vm;
+    streamed.buf = NULL;
+    streamed.len = 0;
+    stream_error = jsonnet_evaluate_file_stream(vm, argv[1], append, &streamed, &error);
+    if (error || streamed.buf == NULL || strcmp(streamed.buf, output) != 0) {
+        fprintf(stderr, "Streamed output differs: %s", stream_error);
+        jsonnet_realloc(vm, stream_error, 0);
+        jsonnet_realloc(vm, streamed.buf, 0);
+        jsonnet_realloc(vm, output, 0);
+        jsonnet_destroy(vm);
+        return EXIT_FAILURE;
+    }
+    jsonnet_realloc(vm, stream_error, 0);
+    jsonnet_realloc(vm, streamed.buf, 0);
+
+    /* So should visiting the values and writing them out again. */
+    rewritten.out.vm = vm;
+    rewritten.out.buf = NULL;
+    rewritten.out.len = 0;
+    rewritten.depth = 0;
+    rewritten.after_key = 0;
+    visit_error = jsonnet_evaluate_file_visit(vm, argv[1], &rewriter, &rewritten, &error);
+    if (!error) write_str(&rewritten, "\n");
+    if (error || strcmp(rewritten.out.buf, output) != 0) {
+        fprintf(stderr, "Visited output differs: %s", visit_error);
+        jsonnet_realloc(vm, visit_error, 0);
+        jsonnet_realloc(vm, rewritten.out.buf, 0);
+        jsonnet_realloc(vm, output, 0);
+        jsonnet_destroy(vm);
+        return EXIT_FAILURE;
+    }
+    jsonnet_realloc(vm, visit_error, 0);
+    jsonnet_realloc(vm, rewritten.out.buf, 0);
+
     printf("%s", output);
     jsonnet_realloc(vm, output, 0);
     jsonnet_destroy(vm);
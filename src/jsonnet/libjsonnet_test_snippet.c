@@ -16,9 +16,83 @@ limitations under the License.
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "libjsonnet.h"
 
+/** Files that take a little while to manifest, and the same with some errors. */
+static const char *multi_snippets[] = {
+    "{ [\"file\" + i]: std.foldl(function(a, b) a + b, std.range(0, 1000 * i), 0) "
+    "for i in std.range(0, 15) }",
+    "{ [\"file\" + i]: if i % 7 == 3 then error \"file \" + i else std.range(0, 1000 * i) "
+    "for i in std.range(0, 15) }",
+};
+
+/** The length of the output of jsonnet_evaluate_snippet_multi, including the final \0. */
+static size_t multi_length(const char *output, int error)
+{
+    const char *c = output;
+    if (error) return strlen(output) + 1;
+    while (*c != '\0') c += strlen(c) + 1;
+    return c - output + 1;
+}
+
+/** Check that writing multiple files on several threads gives the same output as one thread. */
+static int check_multi_threads(struct JsonnetVm *vm)
+{
+    unsigned i;
+    for (i = 0 ; i < sizeof(multi_snippets) / sizeof(*multi_snippets) ; ++i) {
+        int error, threaded_error, same;
+        char *output, *threaded;
+        jsonnet_max_threads(vm, 1);
+        output = jsonnet_evaluate_snippet_multi(vm, "multi", multi_snippets[i], &error);
+        jsonnet_max_threads(vm, 4);
+        threaded = jsonnet_evaluate_snippet_multi(vm, "multi", multi_snippets[i],
+                                                  &threaded_error);
+        same = error == threaded_error
+            && multi_length(output, error) == multi_length(threaded, threaded_error)
+            && memcmp(output, threaded, multi_length(output, error)) == 0;
+        if (!same) {
+            fprintf(stderr, "Output from several threads differs: %s\n", multi_snippets[i]);
+        }
+        jsonnet_realloc(vm, output, 0);
+        jsonnet_realloc(vm, threaded, 0);
+        if (!same) return 0;
+    }
+    jsonnet_max_threads(vm, 1);
+    return 1;
+}
+
+/** Import a file, and import it again once it has changed. */
+static int check_changed_import(struct JsonnetVm *vm)
+{
+    static const char *filename = "libjsonnet_test_snippet.import.jsonnet";
+    static const char *versions[] = { "{ x: 1 }", "{ x: 1, y: 2 }" };
+    static const char *expected[] = { "1\n", "3\n" };
+    unsigned i;
+    int ok = 1;
+    for (i = 0 ; i < 2 && ok ; ++i) {
+        int error;
+        char *output;
+        FILE *f = fopen(filename, "w");
+        if (f == NULL || fputs(versions[i], f) < 0 || fclose(f) != 0) {
+            fprintf(stderr, "Could not write %s\n", filename);
+            return 0;
+        }
+        output = jsonnet_evaluate_snippet(vm, "import", "local f = import "
+                                          "\"libjsonnet_test_snippet.import.jsonnet\"; "
+                                          "f.x + (if std.objectHas(f, \"y\") then f.y else 0)",
+                                          &error);
+        if (error || strcmp(output, expected[i]) != 0) {
+            fprintf(stderr, "Import of version %u of %s gave: %s", i, filename, output);
+            ok = 0;
+        }
+        jsonnet_realloc(vm, output, 0);
+    }
+    remove(filename);
+    return ok;
+}
+
 int main(int argc, const char **argv)
 {
     int error;
@@ -36,6 +110,11 @@ int main(int argc, const char **argv)
         jsonnet_destroy(vm);
         return EXIT_FAILURE;
     } 
+    if (!check_multi_threads(vm) || !check_changed_import(vm)) {
+        jsonnet_realloc(vm, output, 0);
+        jsonnet_destroy(vm);
+        return EXIT_FAILURE;
+    }
     printf("%s", output);
     jsonnet_realloc(vm, output, 0);
     jsonnet_destroy(vm);
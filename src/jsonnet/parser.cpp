@@ -19,16 +19,18 @@ limitations under the License.
 #include <cmath>
 
 #include <list>
-#include <set>
 #include <sstream>
 #include <string>
 #include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
 
 
 #include "static_error.h"
 #include "ast.h"
 #include "parser.h"
 #include "lexer.h"
+#include "static_analysis.h"
 
 
 namespace {
@@ -76,9 +78,13 @@ namespace {
         return r;
     }
 
-    std::map<std::string, UnaryOp> build_unary_map(void)
+    /** Operators by their lexemes.  The keys are string literals, so the slices never dangle. */
+    typedef std::unordered_map<StringSlice, UnaryOp, StringSliceHash> UnaryMap;
+    typedef std::unordered_map<StringSlice, BinaryOp, StringSliceHash> BinaryMap;
+
+    UnaryMap build_unary_map(void)
     {
-        std::map<std::string, UnaryOp> r;
+        UnaryMap r;
         r["!"] = UOP_NOT;
         r["~"] = UOP_BITWISE_NOT;
         r["+"] = UOP_PLUS;
@@ -86,9 +92,9 @@ namespace {
         return r;
     }
 
-    std::map<std::string, BinaryOp> build_binary_map(void)
+    BinaryMap build_binary_map(void)
     {
-        std::map<std::string, BinaryOp> r;
+        BinaryMap r;
 
         r["*"] = BOP_MULT;
         r["/"] = BOP_DIV;
@@ -120,7 +126,7 @@ namespace {
     auto unary_map = build_unary_map();
     auto binary_map = build_binary_map();
 
-    bool op_is_unary(const std::string &op, UnaryOp &uop)
+    bool op_is_unary(const StringSlice &op, UnaryOp &uop)
     {
         auto it = unary_map.find(op);
         if (it == unary_map.end()) return false;
@@ -128,7 +134,7 @@ namespace {
         return true;
     }
 
-    bool op_is_binary(const std::string &op, BinaryOp &bop)
+    bool op_is_binary(const StringSlice &op, BinaryOp &bop)
     {
         auto it = binary_map.find(op);
         if (it == binary_map.end()) return false;
@@ -138,17 +144,17 @@ namespace {
 
     LocationRange span(const Token &begin)
     {
-        return LocationRange(begin.location.file, begin.location.begin, begin.location.end);
+        return begin.location();
     }
 
     LocationRange span(const Token &begin, const Token &end)
     {
-        return LocationRange(begin.location.file, begin.location.begin, end.location.end);
+        return LocationRange(*begin.file, begin.begin, end.end);
     }
 
     LocationRange span(const Token &begin, AST *end)
     {
-        return LocationRange(begin.location.file, begin.location.begin, end->location.end);
+        return LocationRange(*begin.file, begin.begin, end->location.end);
     }
 
     /** Holds state while parsing a given token list.
@@ -161,20 +167,20 @@ namespace {
         {
             std::stringstream ss;
             ss << "Unexpected: " << tok.kind << " while " << while_;
-            return StaticError(tok.location, ss.str());
+            return StaticError(tok.location(), ss.str());
         }
 
         Token pop(void)
         {
             Token tok = peek();
-            tokens->pop_front();
+            // Stay on the END_OF_FILE token at the end.
+            if (pos + 1 < tokens->size()) pos++;
             return tok;
         }
 
         Token peek(void)
         {
-            Token tok = tokens->front();
-            return tok;
+            return (*tokens)[pos];
         }
 
         Token popExpect(Token::Kind k, const char *data=nullptr)
@@ -183,25 +189,35 @@ namespace {
             if (tok.kind != k) {
                 std::stringstream ss;
                 ss << "Expected token " << k << " but got " << tok;
-                throw StaticError(tok.location, ss.str());
+                throw StaticError(tok.location(), ss.str());
             }
             if (data != nullptr && tok.data != data) {
                 std::stringstream ss;
                 ss << "Expected operator " << data << " but got " << tok.data;
-                throw StaticError(tok.location, ss.str());
+                throw StaticError(tok.location(), ss.str());
             }
             return tok;
         }
 
-        std::list<Token> *tokens;
+        const std::vector<Token> *tokens;
+
+        /** The index of the next token. */
+        size_t pos;
+
         Allocator *alloc;
 
         public:
 
-        Parser(std::list<Token> *tokens, Allocator *alloc)
-          : tokens(tokens), alloc(alloc)
+        Parser(const std::vector<Token> *tokens, Allocator *alloc)
+          : tokens(tokens), pos(0), alloc(alloc)
         { }
 
+        /** Returns the next token, without using it up. */
+        const Token &remaining(void)
+        {
+            return (*tokens)[pos];
+        }
+
         /** Parse a comma-separated list of expressions.
          *
          * Allows an optional ending comma.
@@ -232,7 +248,7 @@ namespace {
                 if (!got_comma) {
                     std::stringstream ss;
                     ss << "Expected a comma before next " << element_kind <<  ".";
-                    throw StaticError(next.location, ss.str());
+                    throw StaticError(next.location(), ss.str());
                 }
                 exprs.push_back(parse(MAX_PRECEDENCE, obj_level));
                 got_comma = false;
@@ -265,8 +281,8 @@ namespace {
             Token var_id = popExpect(Token::IDENTIFIER);
             auto *id = alloc->makeIdentifier(var_id.data);
             if (binds.find(id) != binds.end()) {
-                throw StaticError(var_id.location,
-                                  "Duplicate local var: " + var_id.data);
+                throw StaticError(var_id.location(),
+                                  "Duplicate local var: " + var_id.data.str());
             }
             AST *init;
             if (peek().kind == Token::PAREN_L) {
@@ -285,7 +301,7 @@ namespace {
 
         Token parseObjectRemainder(AST *&obj, const Token &tok, unsigned obj_level)
         {
-            std::set<std::string> literal_fields;
+            std::unordered_set<StringSlice, StringSliceHash> literal_fields;
             Object::Fields fields;
             std::map<const Identifier*, AST*> let_binds;
 
@@ -324,11 +340,11 @@ namespace {
                 } else if (next.kind == Token::FOR) {
                     if (fields.size() != 1) {
                         auto msg = "Object composition can only have one field/value pair.";
-                        throw StaticError(next.location, msg);
+                        throw StaticError(next.location(), msg);
                     }
                     if (last_was_local) {
                         auto msg = "Locals must appear first in an object comprehension.";
-                        throw StaticError(next.location, msg);
+                        throw StaticError(next.location(), msg);
                     }
                     AST *field = fields.front().name;
                     Object::Field::Hide field_hide = fields.front().hide;
@@ -338,10 +354,10 @@ namespace {
                     }
                     if (field_hide != Object::Field::INHERIT) {
                         auto msg = "Object comprehensions cannot have hidden fields.";
-                        throw StaticError(next.location, msg);
+                        throw StaticError(next.location(), msg);
                     }
                     if (got_comma) {
-                        throw StaticError(next.location, "Unexpected comma before for.");
+                        throw StaticError(next.location(), "Unexpected comma before for.");
                     }
                     Token id_tok = popExpect(Token::IDENTIFIER);
                     const Identifier *id = alloc->makeIdentifier(id_tok.data);
@@ -352,7 +368,7 @@ namespace {
                     return last;
                 }
                 if (!got_comma)
-                    throw StaticError(next.location, "Expected a comma before next field.");
+                    throw StaticError(next.location(), "Expected a comma before next field.");
 
                 switch (next.kind) {
                     case Token::IDENTIFIER: case Token::STRING: {
@@ -368,13 +384,13 @@ namespace {
                         bool plus_sugar = false;
                         LocationRange plus_loc;
                         if (peek().kind == Token::OPERATOR && peek().data == "+") {
-                            plus_loc = peek().location;
+                            plus_loc = peek().location();
                             plus_sugar = true;
                             pop();
                         }
 
                         if (is_method && plus_sugar) {
-                            throw StaticError(next.location, "Cannot use +: syntax sugar in a method: "+next.data);
+                            throw StaticError(next.location(), "Cannot use +: syntax sugar in a method: "+next.data.str());
                         }
 
                         popExpect(Token::COLON);
@@ -388,16 +404,16 @@ namespace {
                             }
                         }
                         if (!literal_fields.insert(next.data).second) {
-                            throw StaticError(next.location, "Duplicate field: "+next.data);
+                            throw StaticError(next.location(), "Duplicate field: "+next.data.str());
                         }
-                        AST *field_expr = alloc->make<LiteralString>(next.location, next.data);
+                        AST *field_expr = alloc->make<LiteralString>(next.location(), next.data.str());
 
                         AST *body = parse(MAX_PRECEDENCE, obj_level+1);
                         if (is_method) {
                             body = alloc->make<Function>(body->location, params, body);
                         }
                         if (plus_sugar) {
-                            AST *f = alloc->make<LiteralString>(plus_loc, next.data);
+                            AST *f = alloc->make<LiteralString>(plus_loc, next.data.str());
                             AST *super_f = alloc->make<Index>(plus_loc, alloc->make<Super>(LocationRange()), f);
                             body = alloc->make<Binary>(body->location, super_f, BOP_PLUS, body);
                         }
@@ -462,7 +478,7 @@ namespace {
                 throw unexpected(tok, "parsing terminal");
 
                 case Token::END_OF_FILE:
-                throw StaticError(tok.location, "Unexpected end of file.");
+                throw StaticError(tok.location(), "Unexpected end of file.");
 
                 case Token::BRACE_L: {
                     AST *obj;
@@ -505,7 +521,7 @@ namespace {
                         } else {
                             std::stringstream ss;
                             ss << "Expected if or ] after for clause, got: " << maybe_if;
-                            throw StaticError(next.location, ss.str());
+                            throw StaticError(next.location(), ss.str());
                         }
                     } else {
                         std::vector<AST*> elements;
@@ -525,7 +541,7 @@ namespace {
                             if (!got_comma) {
                                 std::stringstream ss;
                                 ss << "Expected a comma before next array element.";
-                                throw StaticError(next.location, ss.str());
+                                throw StaticError(next.location(), ss.str());
                             }
                             elements.push_back(parse(MAX_PRECEDENCE, obj_level));
                         } while (true);
@@ -542,10 +558,10 @@ namespace {
 
                 // Literals
                 case Token::NUMBER:
-                return alloc->make<LiteralNumber>(span(tok), strtod(tok.data.c_str(), nullptr));
+                return alloc->make<LiteralNumber>(span(tok), strtod(tok.data.str().c_str(), nullptr));
 
                 case Token::STRING:
-                return alloc->make<LiteralString>(span(tok), tok.data);
+                return alloc->make<LiteralString>(span(tok), tok.data.str());
 
                 case Token::FALSE:
                 return alloc->make<LiteralBoolean>(span(tok), false);
@@ -559,19 +575,19 @@ namespace {
                 // Import
                 case Token::IMPORT: {
                     Token file = popExpect(Token::STRING);
-                    return alloc->make<Import>(span(tok, file), file.data);
+                    return alloc->make<Import>(span(tok, file), file.data.str());
                 }
 
                 case Token::IMPORTSTR: {
                     Token file = popExpect(Token::STRING);
-                    return alloc->make<Importstr>(span(tok, file), file.data);
+                    return alloc->make<Importstr>(span(tok, file), file.data.str());
                 }
 
 
                 // Variables
                 case Token::DOLLAR:
                 if (obj_level == 0) {
-                    throw StaticError(tok.location, "No top-level object found.");
+                    throw StaticError(tok.location(), "No top-level object found.");
                 }
                 return alloc->make<Var>(span(tok), alloc->makeIdentifier("$"));
 
@@ -642,7 +658,7 @@ namespace {
                     } else {
                         std::stringstream ss;
                         ss << "Expected ( but got " << next;
-                        throw StaticError(next.location, ss.str());
+                        throw StaticError(next.location(), ss.str());
                     }
                 }
 
@@ -655,7 +671,7 @@ namespace {
                         if (delim.kind != Token::SEMICOLON && delim.kind != Token::COMMA) {
                             std::stringstream ss;
                             ss << "Expected , or ; but got " << delim;
-                            throw StaticError(delim.location, ss.str());
+                            throw StaticError(delim.location(), ss.str());
                         }
                         if (delim.kind == Token::SEMICOLON) break;
                     } while (true);
@@ -671,7 +687,7 @@ namespace {
                     if (!op_is_unary(begin.data, uop)) {
                         std::stringstream ss;
                         ss << "Not a unary operator: " << begin.data;
-                        throw StaticError(begin.location, ss.str());
+                        throw StaticError(begin.location(), ss.str());
                     }
                     if (UNARY_PRECEDENCE == precedence) {
                         Token op = pop();
@@ -704,7 +720,7 @@ namespace {
                             if (!op_is_binary(peek().data, bop)) {
                                 std::stringstream ss;
                                 ss << "Not a binary operator: " << peek().data;
-                                throw StaticError(peek().location, ss.str());
+                                throw StaticError(peek().location(), ss.str());
                             }
                             if (precedence_map[bop] != precedence) return lhs;
                         }
@@ -728,7 +744,7 @@ namespace {
 
                     } else if (op.kind == Token::DOT) {
                         Token field = popExpect(Token::IDENTIFIER);
-                        AST *index = alloc->make<LiteralString>(span(field), field.data);
+                        AST *index = alloc->make<LiteralString>(span(field), field.data.str());
                         lhs = alloc->make<Index>(span(begin, field), lhs, index);
 
                     } else if (op.kind == Token::PAREN_L) {
@@ -815,15 +831,16 @@ BuiltinDecl jsonnet_builtin_decl(unsigned long builtin)
 static AST *do_parse(Allocator *alloc, const std::string &file, const char *input)
 {
     // Lex the input.
-    auto token_list = jsonnet_lex(file, input);
+    Tokens tokens = jsonnet_lex(file, input);
 
     // Parse the input.
-    Parser parser(&token_list, alloc);
+    Parser parser(&tokens.tokens, alloc);
     AST *expr = parser.parse(MAX_PRECEDENCE, 0);
-    if (token_list.front().kind != Token::END_OF_FILE) {
+    const Token &remaining = parser.remaining();
+    if (remaining.kind != Token::END_OF_FILE) {
         std::stringstream ss;
-        ss << "Did not expect: " << token_list.front();
-        throw StaticError(token_list.front().location, ss.str());
+        ss << "Did not expect: " << remaining;
+        throw StaticError(remaining.location(), ss.str());
     }
 
     return expr;
@@ -833,30 +850,71 @@ static constexpr char STD_CODE[] = {
     #include "std.jsonnet.h"
 };
 
+namespace {
+
+/** The std object, parsed and analysed once per process and then shared, read-only, by every
+ * AST that jsonnet_parse returns.
+ */
+struct StdLibrary {
+    /** Owns the std AST, and the identifiers within it. */
+    Allocator alloc;
+    /** The std object, with its natively implemented builtins bound. */
+    Object *object;
+    /** The identifier that the std object uses to refer to itself. */
+    const Identifier *id;
+
+    StdLibrary(void)
+    {
+        object = static_cast<Object*>(do_parse(&alloc, "std.jsonnet", STD_CODE));
+        id = alloc.makeIdentifier("std");
+
+        // For generated ASTs, use a bogus location.
+        const LocationRange l;
+
+        // Bind 'std' builtins that are implemented natively.
+        Object::Fields &fields = object->fields;
+        for (unsigned long c=0 ; c <= max_builtin ; ++c) {
+            const auto &decl = jsonnet_builtin_decl(c);
+            std::vector<const Identifier*> params;
+            for (const auto &p : decl.params)
+                params.push_back(alloc.makeIdentifier(p));
+            fields.emplace_back(alloc.make<LiteralString>(l, decl.name), Object::Field::HIDDEN,
+                                alloc.make<BuiltinFunction>(l, c, params));
+        }
+
+        // Analyse it now, while nothing else can see it.  Its only free variable is std.
+        Local::Binds binds;
+        binds[id] = object;
+        jsonnet_static_analysis(alloc.make<Local>(l, binds, alloc.make<LiteralNull>(l)));
+    }
+};
+
+}  // namespace
+
+/** Returns the std library, which is built the first time this is called.  Thread-safe. */
+static const StdLibrary &std_library(void)
+{
+    static const StdLibrary library;
+    return library;
+}
+
 AST *jsonnet_parse(Allocator *alloc, const std::string &file, const char *input)
 {
     // Parse the actual file.
     AST *expr = do_parse(alloc, file, input);
 
-    // Now, implement the std library by wrapping in a local construct.
-    auto *std_obj = static_cast<Object*>(do_parse(alloc, "std.jsonnet", STD_CODE));
+    // Now, implement the std library by wrapping in a local construct.  The shared std object
+    // refers to itself by its own identifier, which is distinct from the one in alloc, so bind
+    // both.
+    const StdLibrary &library = std_library();
+    const Identifier *std_id = alloc->makeIdentifier("std");
 
     // For generated ASTs, use a bogus location.
     const LocationRange l;
 
-    // Bind 'std' builtins that are implemented natively.
-    Object::Fields &fields = std_obj->fields;
-    for (unsigned long c=0 ; c <= max_builtin ; ++c) {
-        const auto &decl = jsonnet_builtin_decl(c);
-        std::vector<const Identifier*> params;
-        for (const auto &p : decl.params)
-            params.push_back(alloc->makeIdentifier(p));
-        fields.emplace_back(alloc->make<LiteralString>(l, decl.name), Object::Field::HIDDEN,
-                            alloc->make<BuiltinFunction>(l, c, params));
-    }
-
     Local::Binds std_binds;
-    std_binds[alloc->makeIdentifier("std")] = std_obj;
+    std_binds[std_id] = library.object;
+    std_binds[library.id] = alloc->make<Var>(l, std_id);
     AST *wrapped = alloc->make<Local>(expr->location, std_binds, expr);
     return wrapped;
 }
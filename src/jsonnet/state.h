@@ -19,14 +19,21 @@ limitations under the License.
 
 namespace {
 
-    /** Mark & sweep: advanced by 1 each GC cycle.
-     */
-    typedef unsigned char GarbageCollectionMark;
-
     /** Supertype of everything that is allocated on the heap.
      */
     struct HeapEntity {
-        GarbageCollectionMark mark;
+        /** Reachable in the current garbage collection cycle. */
+        bool marked;
+
+        /** Survived a garbage collection cycle, so it is only collected by major cycles. */
+        bool mature;
+
+        /** Mature, and has been changed to refer to other entities since the last cycle. */
+        bool remembered;
+
+        /** The Heap's arena that holds it. */
+        unsigned char sizeClass;
+
         virtual ~HeapEntity() { }
     };
 
@@ -90,8 +97,53 @@ namespace {
      */
     typedef std::map<const Identifier*, HeapThunk*> BindingFrame;
 
+    struct HeapLeafObject;
+
+    /** Every field of an object, flattened out of its tree of extended objects.
+     *
+     * Built the first time the object is indexed, so that indexing it again does not have to
+     * search the tree.  Objects are immutable, so it never needs to be rebuilt.  Everything it
+     * points to is reachable from the object, so it need not be considered by the garbage
+     * collector.
+     */
+    struct FieldTable {
+        /** Where a field is defined. */
+        struct Definition {
+            /** The leaf object that defines the field. */
+            HeapLeafObject *leaf;
+
+            /** The number of leaves to the right of it, i.e. the offset of self. */
+            unsigned counter;
+
+            /** The field's expression, if leaf is a HeapSimpleObject. */
+            const AST *body;
+
+            /** The value bound to the variable, if leaf is a HeapComprehensionObject. */
+            HeapThunk *thunk;
+        };
+
+        /** False if the tree contains a super object, in which case it has to be searched.
+         * The table is left empty.
+         */
+        bool flat;
+
+        /** The number of leaves in the tree. */
+        unsigned leaves;
+
+        /** The definitions of each field, from the rightmost leaf to the leftmost.  The first
+         * definition is the one that is used, the others are reached via super.
+         */
+        std::unordered_map<const Identifier*, std::vector<Definition>> fields;
+
+        FieldTable(void)
+          : flat(true), leaves(0)
+        { }
+    };
+
     /** Supertype of all objects.  Types of Value::OBJECT will point at these.  */
     struct HeapObject : public HeapEntity {
+        /** Built the first time the object is indexed, null until then. */
+        std::unique_ptr<FieldTable> fieldTable;
     };
 
     /** Hold an unevaluated expression.  This implements lazy semantics.
@@ -134,14 +186,80 @@ namespace {
         }
     };
 
+    /** Arrays are concatenated in the same way as strings.
+     *
+     * Concatenating two arrays that are not short makes a node that points at both of them, and
+     * the elements are copied into a single vector (flattened) the first time they are needed.
+     * So building an array up an element at a time, e.g. with std.foldl, takes linear rather
+     * than quadratic time and memory.  \see HeapString
+     */
     struct HeapArray : public HeapEntity {
+        /** Concatenations whose result has at most this many elements copy the elements. */
+        static constexpr size_t FLAT_LIMIT = 32;
+
+        /** The arrays concatenated to make this one, or nullptr if it is flat. */
+        mutable HeapArray *left;
+        mutable HeapArray *right;
+
+        HeapArray(const std::vector<HeapThunk*> &elements)
+          : left(nullptr), right(nullptr), concatLength(0), elems(elements)
+        { }
+
+        HeapArray(HeapArray *left, HeapArray *right)
+          : left(left), right(right), concatLength(left->length() + right->length())
+        { }
+
+        /** The number of elements, available without flattening. */
+        size_t length(void) const
+        {
+            return left == nullptr ? elems.size() : concatLength;
+        }
+
+        /** The elements, flattening the array first if necessary. */
+        const std::vector<HeapThunk*> &elements(void) const
+        {
+            if (left != nullptr) flatten();
+            return elems;
+        }
+
         // It is convenient for this to not be const, so that we can add elements to it one at a
         // time after creation.  Thus, elements are not GCed as the array is being
         // created.
-        std::vector<HeapThunk*> elements;
-        HeapArray(const std::vector<HeapThunk*> &elements)
-          : elements(elements)
-        { }
+        std::vector<HeapThunk*> &elements(void)
+        {
+            if (left != nullptr) flatten();
+            return elems;
+        }
+
+        private:
+
+        /** The number of elements, if not flat. */
+        size_t concatLength;
+
+        /** The elements, once flat. */
+        mutable std::vector<HeapThunk*> elems;
+
+        void flatten(void) const
+        {
+            // Arrays built in a loop are very deep, so do not recurse.
+            std::vector<HeapThunk*> r;
+            r.reserve(concatLength);
+            std::vector<const HeapArray*> todo;
+            todo.push_back(this);
+            while (todo.size() > 0) {
+                const HeapArray *a = todo.back();
+                todo.pop_back();
+                if (a->left == nullptr) {
+                    r.insert(r.end(), a->elems.begin(), a->elems.end());
+                } else {
+                    todo.push_back(a->right);
+                    todo.push_back(a->left);
+                }
+            }
+            elems.swap(r);
+            left = nullptr;
+            right = nullptr;
+        }
     };
 
     /** Supertype of all objects that are not super objects or extended objects.  */
@@ -252,68 +370,284 @@ namespace {
         { }
     };
 
-    /** Stores a simple string on the heap. */
+    /** Strings are ropes.
+     *
+     * Concatenating two strings that are not short makes a node that points at both of them,
+     * rather than copying their characters.  The characters are copied into a single string
+     * (flattened) the first time they are needed, so building a long string up a piece at a time
+     * takes linear rather than quadratic time and memory.
+     */
     struct HeapString : public HeapEntity {
-        const std::string value;
+        /** Concatenations whose result is at most this long copy the characters. */
+        static constexpr size_t FLAT_LIMIT = 64;
+
+        /** The strings concatenated to make this one, or nullptr if it is flat. */
+        mutable HeapString *left;
+        mutable HeapString *right;
+
+        /** The number of characters, available without flattening. */
+        const size_t length;
+
         HeapString(const std::string &value)
-          : value(value)
+          : left(nullptr), right(nullptr), length(value.length()), str(value)
+        { }
+
+        HeapString(HeapString *left, HeapString *right)
+          : left(left), right(right), length(left->length + right->length)
         { }
+
+        /** The characters, flattening the string first if necessary. */
+        const std::string &value(void) const
+        {
+            if (left != nullptr) flatten();
+            return str;
+        }
+
+        private:
+
+        /** The characters, once flat. */
+        mutable std::string str;
+
+        void flatten(void) const
+        {
+            // Ropes built in a loop are very deep, so do not recurse.
+            std::string r;
+            r.reserve(length);
+            std::vector<const HeapString*> todo;
+            todo.push_back(this);
+            while (todo.size() > 0) {
+                const HeapString *s = todo.back();
+                todo.pop_back();
+                if (s->left == nullptr) {
+                    r += s->str;
+                } else {
+                    todo.push_back(s->right);
+                    todo.push_back(s->left);
+                }
+            }
+            str.swap(r);
+            left = nullptr;
+            right = nullptr;
+        }
     };
 
-    /** The heap does memory management, i.e. garbage collection. */
+    /** Memory for heap entities of one size.
+     *
+     * Slots are bump-allocated from large chunks, and freed slots are kept on a free list to be
+     * reused by the next allocations.  Chunks are only returned to the system when the arena is
+     * destroyed.
+     */
+    class Arena {
+
+        /** Entities per chunk. */
+        static constexpr size_t SLOTS_PER_CHUNK = 1024;
+
+        /** The size of every slot, a multiple of the alignment of any entity. */
+        size_t slotSize;
+
+        std::vector<char*> chunks;
+
+        /** The unallocated part of the last chunk. */
+        char *next;
+        char *end;
+
+        /** Freed slots, each holding a pointer to the next. */
+        void *freeList;
+
+        public:
+
+        Arena(size_t slot_size)
+          : slotSize(slot_size), next(nullptr), end(nullptr), freeList(nullptr)
+        { }
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena(void)
+        {
+            for (char *chunk : chunks)
+                ::operator delete(chunk);
+        }
+
+        void *allocate(void)
+        {
+            if (freeList != nullptr) {
+                void *r = freeList;
+                freeList = *static_cast<void**>(r);
+                return r;
+            }
+            if (next == end) {
+                next = static_cast<char*>(::operator new(slotSize * SLOTS_PER_CHUNK));
+                end = next + slotSize * SLOTS_PER_CHUNK;
+                chunks.push_back(next);
+            }
+            void *r = next;
+            next += slotSize;
+            return r;
+        }
+
+        void release(void *slot)
+        {
+            *static_cast<void**>(slot) = freeList;
+            freeList = slot;
+        }
+    };
+
+    /** The heap does memory management, i.e. garbage collection.
+     *
+     * The collector is generational, but does not move entities.  Entities start out young, and
+     * the ones that survive a collection cycle become mature.  A minor cycle only marks and sweeps
+     * the young entities, assuming that all mature ones are reachable.  Since most entities (e.g.
+     * thunks) die young, this is much quicker than marking everything.  A major cycle marks and
+     * sweeps the whole heap, and happens when the mature entities have grown enough.
+     *
+     * A mature entity can only refer to a young one if it was changed after the last cycle.  Such
+     * changes must be reported with writeBarrier(), and the entities changed are used as extra
+     * roots in the next minor cycle.
+     *
+     * Entities are allocated from arenas by size, rather than individually with new.
+     */
     class Heap {
 
-        /** How many objects must exist in the heap before we bother doing garbage collection?
+        /** How many young objects can exist before a minor collection cycle.
          */
         unsigned gcTuneMinObjects;
 
-        /** How much must the heap have grown since the last cycle to trigger a collection?
+        /** How much must the mature objects have grown since the last major cycle to trigger
+         * another?
          */
         double gcTuneGrowthTrigger;
 
-        /** Value used to mark entities at the last garbage collection cycle. */
-        GarbageCollectionMark lastMark;
+        /** Whether the current cycle is a major cycle. */
+        bool major;
+
+        /** The entities allocated since the last cycle. */
+        std::vector<HeapEntity*> young;
 
-        /** The heap entities (strings, arrays, objects, functions, etc).
+        /** The entities that survived a cycle.
          *
-         * Not all may be reachable, all should have o->mark == this->lastMark.  Entities are
-         * removed from the heap via O(1) swap with last element, so the ordering of entities is
-         * arbitrary and changes every garbage collection cycle.
+         * Entities are removed via O(1) swap with last element, so the ordering of entities is
+         * arbitrary and changes every major garbage collection cycle.
          */
-        std::vector<HeapEntity*> entities;
+        std::vector<HeapEntity*> mature;
 
-        /** The number of heap entities at the last garbage collection cycle. */
-        unsigned long lastNumEntities;
+        /** The mature entities changed since the last cycle.  \see writeBarrier */
+        std::vector<HeapEntity*> remembered;
 
-        /** The number of heap entities now. */
-        unsigned long numEntities;
+        /** The number of mature entities after the last major cycle. */
+        unsigned long lastNumMature;
 
-        /** Add the HeapEntity inside v to vec, if the value exists on the heap.   
-         */
-        void addIfHeapEntity(Value v, std::vector<HeapEntity*> &vec)
+        /** The arenas, indexed by entity size in units of ARENA_GRANULE. */
+        std::vector<std::unique_ptr<Arena>> arenas;
+
+        /** Entities to be traversed during marking. */
+        std::vector<HeapEntity*> markStack;
+
+        /** The size of every arena's slots is a multiple of this. */
+        static constexpr size_t ARENA_GRANULE = 16;
+
+        /** Mark v, and queue it to have the entities it refers to marked. */
+        void addIfHeapEntity(Value v)
         {
-            if (v.isHeap()) vec.push_back(v.v.h);
+            if (v.isHeap()) addIfHeapEntity(v.v.h);
         }
 
-        /** Add the HeapEntity inside v to vec, if the value exists on the heap.   
+        /** Mark v, and queue it to have the entities it refers to marked.
+         *
+         * Mature entities are not marked in a minor cycle, as they are not being collected.
          */
-        void addIfHeapEntity(HeapEntity *v, std::vector<HeapEntity*> &vec)
+        void addIfHeapEntity(HeapEntity *v)
         {
-            vec.push_back(v);
+            if (v->marked || (v->mature && !major)) return;
+            v->marked = true;
+            markStack.push_back(v);
+        }
+
+        /** Mark the entities that ent refers to. */
+        void addChildren(HeapEntity *ent)
+        {
+            if (auto *obj = dynamic_cast<HeapSimpleObject*>(ent)) {
+                for (auto upv : obj->upValues)
+                    addIfHeapEntity(upv.second);
+
+            } else if (auto *obj = dynamic_cast<HeapExtendedObject*>(ent)) {
+                addIfHeapEntity(obj->left);
+                addIfHeapEntity(obj->right);
+
+            } else if (auto *obj = dynamic_cast<HeapComprehensionObject*>(ent)) {
+                for (auto upv : obj->upValues)
+                    addIfHeapEntity(upv.second);
+                for (auto upv : obj->compValues)
+                    addIfHeapEntity(upv.second);
+
+            } else if (auto *obj = dynamic_cast<HeapSuperObject*>(ent)) {
+                addIfHeapEntity(obj->root);
+
+            } else if (auto *arr = dynamic_cast<HeapArray*>(ent)) {
+                if (arr->left != nullptr) {
+                    addIfHeapEntity(arr->left);
+                    addIfHeapEntity(arr->right);
+                } else {
+                    for (auto el : arr->elements())
+                        addIfHeapEntity(el);
+                }
+
+            } else if (auto *func = dynamic_cast<HeapClosure*>(ent)) {
+                for (auto upv : func->upValues)
+                    addIfHeapEntity(upv.second);
+                if (func->self)
+                    addIfHeapEntity(func->self);
+
+            } else if (auto *str = dynamic_cast<HeapString*>(ent)) {
+                if (str->left != nullptr) {
+                    addIfHeapEntity(str->left);
+                    addIfHeapEntity(str->right);
+                }
+
+            } else if (auto *thunk = dynamic_cast<HeapThunk*>(ent)) {
+                if (thunk->filled) {
+                    addIfHeapEntity(thunk->content);
+                } else {
+                    for (auto upv : thunk->upValues)
+                        addIfHeapEntity(upv.second);
+                    if (thunk->self)
+                        addIfHeapEntity(thunk->self);
+                }
+            }
+        }
+
+        /** Mark everything reachable from the entities queued by addIfHeapEntity. */
+        void drainMarkStack(void)
+        {
+            while (markStack.size() > 0) {
+                HeapEntity *curr = markStack.back();
+                markStack.pop_back();
+                addChildren(curr);
+            }
+        }
+
+        /** Destroy the entity and return its memory to its arena. */
+        void destroy(HeapEntity *x)
+        {
+            Arena &arena = *arenas[x->sizeClass];
+            x->~HeapEntity();
+            arena.release(x);
         }
 
         public:
 
         Heap(unsigned gc_tune_min_objects, double gc_tune_growth_trigger)
           : gcTuneMinObjects(gc_tune_min_objects), gcTuneGrowthTrigger(gc_tune_growth_trigger),
-            lastMark(0), lastNumEntities(0), numEntities(0)
+            major(false), lastNumMature(0)
         {
         }
 
         ~Heap(void)
         {
-            // Nothing is marked, everything will be collected.
-            sweep();
+            for (HeapEntity *x : young)
+                destroy(x);
+            for (HeapEntity *x : mature)
+                destroy(x);
         }
 
         /** Garbage collection: Mark v, and entities reachable from v. */
@@ -322,116 +656,108 @@ namespace {
             if (v.isHeap()) markFrom(v.v.h);
         }
 
-        /** Garbage collection: Mark heap entities reachable from the given heap entity. */
+        /** Garbage collection: Mark heap entities reachable from the given heap entity.
+         *
+         * In a minor cycle, mature entities and the entities only reachable through them are not
+         * marked.
+         */
         void markFrom(HeapEntity *from)
         {
             assert(from != nullptr);
-            const GarbageCollectionMark thisMark = lastMark + 1;
-            struct State {
-                HeapEntity *ent;
-                std::vector<HeapEntity*> children;
-                State(HeapEntity *ent) : ent(ent) { }
-            };
-
-            std::vector<State> stack;
-            stack.emplace_back(from);
-
-            while (stack.size() > 0) {
-                size_t curr_index = stack.size() - 1;
-                State &s = stack[curr_index];
-                HeapEntity *curr = s.ent;
-                if (curr->mark != thisMark) {
-                    curr->mark = thisMark;
-
-                    if (auto *obj = dynamic_cast<HeapSimpleObject*>(curr)) {
-                        for (auto upv : obj->upValues)
-                            addIfHeapEntity(upv.second, s.children);
-
-                    } else if (auto *obj = dynamic_cast<HeapExtendedObject*>(curr)) {
-                        addIfHeapEntity(obj->left, s.children);
-                        addIfHeapEntity(obj->right, s.children);
-
-                    } else if (auto *obj = dynamic_cast<HeapComprehensionObject*>(curr)) {
-                        for (auto upv : obj->upValues)
-                            addIfHeapEntity(upv.second, s.children);
-                        for (auto upv : obj->compValues)
-                            addIfHeapEntity(upv.second, s.children);
-
-
-                    } else if (auto *obj = dynamic_cast<HeapSuperObject*>(curr)) {
-                        addIfHeapEntity(obj->root, s.children);
-
-                    } else if (auto *arr = dynamic_cast<HeapArray*>(curr)) {
-                        for (auto el : arr->elements)
-                            addIfHeapEntity(el, s.children);
-
-                    } else if (auto *func = dynamic_cast<HeapClosure*>(curr)) {
-                        for (auto upv : func->upValues)
-                            addIfHeapEntity(upv.second, s.children);
-                        if (func->self)
-                            addIfHeapEntity(func->self, s.children);
-
-                    } else if (auto *thunk = dynamic_cast<HeapThunk*>(curr)) {
-                        if (thunk->filled) {
-                            if (thunk->content.isHeap())
-                                addIfHeapEntity(thunk->content.v.h, s.children);
-                        } else {
-                            for (auto upv : thunk->upValues)
-                                addIfHeapEntity(upv.second, s.children);
-                            if (thunk->self)
-                                addIfHeapEntity(thunk->self, s.children);
+            addIfHeapEntity(from);
+            drainMarkStack();
+        }
+
+        /** Delete everything that was not marked in this cycle, and make the rest mature. */
+        void sweep(void)
+        {
+            if (major) {
+                for (HeapEntity *x : remembered)
+                    x->remembered = false;
+                remembered.clear();
+            } else {
+                // Mature entities changed to refer to young ones are roots for a minor cycle.
+                for (HeapEntity *x : remembered) {
+                    x->remembered = false;
+                    addChildren(x);
+                    drainMarkStack();
+                }
+                remembered.clear();
+            }
+
+            if (major) {
+                // Heap shrinks during this loop.  Do not cache mature.size().
+                for (unsigned long i=0 ; i<mature.size() ; ++i) {
+                    HeapEntity *x = mature[i];
+                    if (x->marked) {
+                        x->marked = false;
+                    } else {
+                        destroy(x);
+                        if (i != mature.size() - 1) {
+                            // Swap it with the back.
+                            mature[i] = mature[mature.size()-1];
                         }
+                        mature.pop_back();
+                        --i;
                     }
                 }
+            }
 
-                if (s.children.size() > 0) {
-                    HeapEntity *next = s.children[s.children.size() - 1];
-                    s.children.pop_back();
-                    stack.emplace_back(next);  // CAUTION: s invalidated here
+            for (HeapEntity *x : young) {
+                if (x->marked) {
+                    x->marked = false;
+                    x->mature = true;
+                    mature.push_back(x);
                 } else {
-                    stack.pop_back();  // CAUTION: s invalidated here
+                    destroy(x);
                 }
             }
+            young.clear();
+
+            if (major) lastNumMature = mature.size();
         }
 
-        /** Delete everything that was not marked since the last collection. */
-        void sweep(void)
+        /** Is it time to initiate a GC cycle?  If so, decides whether it is a major one. */
+        bool checkHeap(void)
         {
-            lastMark++;
-            // Heap shrinks during this loop.  Do not cache entities.size().
-            for (unsigned long i=0 ; i<entities.size() ; ++i) {
-                HeapEntity *x = entities[i];
-                if (x->mark != lastMark) {
-                    delete x;
-                    if (i != entities.size() - 1) {
-                        // Swap it with the back.
-                        entities[i] = entities[entities.size()-1];
-                    }
-                    entities.pop_back();
-                    --i;
-                }
-            }
-            lastNumEntities = numEntities = entities.size();
+            if (young.size() <= gcTuneMinObjects) return false;
+            unsigned long num_mature = mature.size() + young.size();
+            major = num_mature > gcTuneMinObjects
+                 && num_mature > gcTuneGrowthTrigger * lastNumMature;
+            return true;
         }
 
-        /** Is it time to initiate a GC cycle? */
-        bool checkHeap(void)
+        /** Report that the entity was changed to refer to other entities after it was made.
+         *
+         * Must be called whenever an entity is changed other than in its constructor, e.g. when a
+         * thunk is filled, otherwise a minor cycle might collect young entities that it refers to.
+         */
+        void writeBarrier(HeapEntity *x)
         {
-            return numEntities > gcTuneMinObjects
-                && numEntities > gcTuneGrowthTrigger * lastNumEntities;
+            if (x->mature && !x->remembered) {
+                x->remembered = true;
+                remembered.push_back(x);
+            }
         }
 
         /** Allocate a heap entity.
          *
-         * If the heap is large enough (\see gcTuneMinObjects) and has grown by enough since the
-         * last collection cycle (\see gcTuneGrowthTrigger), a collection cycle is performed.
+         * If there are enough young entities (\see gcTuneMinObjects), a collection cycle is
+         * performed.
         */
         template <class T, class... Args> T* makeEntity(Args... args)
         {
-            T *r = new T(args...);
-            entities.push_back(r);
-            r->mark = lastMark;
-            numEntities = entities.size();
+            size_t size_class = (sizeof(T) + ARENA_GRANULE - 1) / ARENA_GRANULE;
+            if (size_class >= arenas.size())
+                arenas.resize(size_class + 1);
+            if (arenas[size_class] == nullptr)
+                arenas[size_class].reset(new Arena(size_class * ARENA_GRANULE));
+            T *r = new (arenas[size_class]->allocate()) T(args...);
+            r->marked = false;
+            r->mature = false;
+            r->remembered = false;
+            r->sizeClass = size_class;
+            young.push_back(r);
             return r;
         }
 
@@ -40,6 +40,13 @@ static IdSet static_analysis(AST *ast_, bool in_object, const IdSet &vars)
 {
     IdSet r;
 
+    // Shared ASTs (e.g. the standard library) are only analysed once, and may be in use by other
+    // threads, so must not be written to again.
+    if (ast_->analysed) {
+        r.insert(ast_->freeVariables.begin(), ast_->freeVariables.end());
+        return r;
+    }
+
     if (auto *ast = dynamic_cast<const Apply*>(ast_)) {
         append(r, static_analysis(ast->target, in_object, vars));
         for (AST *arg : ast->arguments)
@@ -158,6 +165,7 @@ static IdSet static_analysis(AST *ast_, bool in_object, const IdSet &vars)
 
     for (auto *id : r)
         ast_->freeVariables.push_back(id);
+    ast_->analysed = true;
 
     return r;
 }
@@ -21,6 +21,9 @@ limitations under the License.
 
 /** Check the ast for appropriate use of self, super, and correctly bound variables.  Also
  * initialize the freeVariables member of function and object ASTs.
+ *
+ * Sub-trees that have already been analysed are skipped, so an AST can be shared between
+ * several parent ASTs.
  */
 void jsonnet_static_analysis(AST *ast);
 
@@ -19,8 +19,18 @@ limitations under the License.
 #include <cassert>
 #include <cmath>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "parser.h"
 #include "state.h"
@@ -382,14 +392,119 @@ namespace {
     /** Typedef to save some typing. */
     typedef std::map<std::string, std::string> StrMap;
 
+    /** Where manifested JSON is written.
+     *
+     * The JSON is appended to a buffer.  If there is a callback, the buffer is passed to it and
+     * emptied whenever it gets large, so that a large output is never held in memory all at once.
+     */
+    struct ManifestOutput {
+        /** How large the buffer can get before it is passed to the callback. */
+        static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+        /** The output not yet passed to the callback. */
+        std::string buf;
+
+        /** Receives the output, or nullptr to keep all of it in buf. */
+        JsonnetOutputCallback *callback;
+
+        /** User context pointer for the callback. */
+        void *callbackContext;
+
+        ManifestOutput(JsonnetOutputCallback *callback = nullptr, void *callback_context = nullptr)
+          : callback(callback), callbackContext(callback_context)
+        { }
+
+        /** Pass the buffer to the callback, if there is one.
+         *
+         * \param final Whether to pass it however small it is.
+         * \returns False if the callback failed.
+         */
+        bool flush(bool final)
+        {
+            if (callback == nullptr || buf.size() == 0) return true;
+            if (!final && buf.size() < FLUSH_SIZE) return true;
+            bool ok = callback(callbackContext, buf.data(), buf.size()) == 0;
+            buf.clear();
+            return ok;
+        }
+    };
+
+
+    /** An imported Jsonnet file, parsed and analysed.  Shared, read-only, by every Interpreter
+     * that imports the same version of the file.
+     */
+    struct ParsedImport {
+        /** The content of the file. */
+        std::string content;
+
+        /** The hash of the content, to tell versions of the file apart quickly. */
+        size_t hash;
+
+        /** Owns the AST, and the identifiers within it.  They are only compared with each other,
+         * like those of the std library.
+         */
+        Allocator alloc;
+
+        AST *expr;
+    };
+
+    /** The latest version of each file imported in the process, by path, so that evaluations
+     * that import the same libraries only parse them once.
+     *
+     * A file is parsed again if its content changes.  The version it replaces is freed when no
+     * Interpreter is using it any more.  Thread-safe.
+     */
+    class ImportCache {
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<const ParsedImport>> files;
+
+        public:
+        /** Returns the file parsed, parsing it if this version hasn't been seen before.
+         *
+         * \param file The path of the file, as it is to appear in error messages.
+         * \param content The content of the file.
+         * \throws StaticError if the file can't be parsed.
+         */
+        std::shared_ptr<const ParsedImport> parse(const std::string &file,
+                                                  const std::string &content)
+        {
+            size_t hash = std::hash<std::string>()(content);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = files.find(file);
+                if (it != files.end() && it->second->hash == hash
+                    && it->second->content == content) {
+                    return it->second;
+                }
+            }
+
+            // Other threads can carry on looking up files while this one is parsed.
+            auto parsed = std::make_shared<ParsedImport>();
+            parsed->content = content;
+            parsed->hash = hash;
+            parsed->expr = jsonnet_parse(&parsed->alloc, file, parsed->content.c_str());
+            jsonnet_static_analysis(parsed->expr);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            files[file] = parsed;
+            return parsed;
+        }
+    };
+
+    /** Returns the import cache for the process. */
+    ImportCache &import_cache(void)
+    {
+        static ImportCache cache;
+        return cache;
+    }
 
     /** Holds the intermediate state during execution and implements the necessary functions to
      * implement the semantics of the language.
      *
-     * The garbage collector used is a simple stop-the-world mark and sweep collector.  It runs upon
-     * memory allocation if the heap is large enough and has grown enough since the last collection.
-     * All reachable entities have their mark field incremented.  Then all entities with the old
-     * mark are removed from the heap.
+     * The garbage collector used is a generational stop-the-world mark and sweep collector.  It
+     * runs upon memory allocation if enough entities have been allocated since the last
+     * collection.  Usually only the young entities are collected, \see Heap.  Any change to an
+     * entity after it was created must be followed by a call to heap.writeBarrier().
      */
     class Interpreter {
 
@@ -414,6 +529,12 @@ namespace {
         /** Cache for imported Jsonnet files. */
         std::map<std::pair<std::string, std::string>, const std::string *> cachedImports;
 
+        /** The imported Jsonnet files that have been parsed.  Holding them here keeps them alive
+         * while the Interpreter is running, even if the import cache moves on to a new version.
+         */
+        std::map<std::pair<std::string, std::string>, std::shared_ptr<const ParsedImport>>
+            parsedImports;
+
         /** External variables for std.extVar. */
         StrMap externalVars;
 
@@ -531,6 +652,48 @@ namespace {
             return r;
         }
 
+        /** Concatenate two strings, without copying them unless the result is short.
+         *
+         * \see HeapString
+         */
+        Value makeConcat(HeapString *left, HeapString *right)
+        {
+            Value r;
+            r.t = Value::STRING;
+            if (left->length == 0) {
+                r.v.h = right;
+            } else if (right->length == 0) {
+                r.v.h = left;
+            } else if (left->length + right->length <= HeapString::FLAT_LIMIT) {
+                r.v.h = makeHeap<HeapString>(left->value() + right->value());
+            } else {
+                r.v.h = makeHeap<HeapString>(left, right);
+            }
+            return r;
+        }
+
+        /** Concatenate two arrays, without copying them unless the result is short.
+         *
+         * \see HeapArray
+         */
+        Value makeConcat(HeapArray *left, HeapArray *right)
+        {
+            Value r;
+            r.t = Value::ARRAY;
+            if (left->length() == 0) {
+                r.v.h = right;
+            } else if (right->length() == 0) {
+                r.v.h = left;
+            } else if (left->length() + right->length() <= HeapArray::FLAT_LIMIT) {
+                std::vector<HeapThunk*> elements = left->elements();
+                elements.insert(elements.end(), right->elements().begin(), right->elements().end());
+                r.v.h = makeHeap<HeapArray>(elements);
+            } else {
+                r.v.h = makeHeap<HeapArray>(left, right);
+            }
+            return r;
+        }
+
         /** Auxiliary function of objectIndex.
          *
          * Traverse the object's tree from right to left, looking for an object
@@ -580,6 +743,57 @@ namespace {
             return nullptr;
         }
 
+        /** Auxiliary function of fieldTable.
+         *
+         * Add the fields of the object's tree to the table, visiting the leaves in the same order
+         * as findObject.
+         *
+         * \param curr The object.
+         * \param table The table to add to.
+         * \returns False if the tree contains a super object.
+         */
+        bool flattenObject(HeapObject *curr, FieldTable &table)
+        {
+            if (auto *ext = dynamic_cast<HeapExtendedObject*>(curr)) {
+                return flattenObject(ext->right, table) && flattenObject(ext->left, table);
+            } else if (dynamic_cast<HeapSuperObject*>(curr)) {
+                return false;
+            } else {
+                if (auto *simp = dynamic_cast<HeapSimpleObject*>(curr)) {
+                    for (const auto &f : simp->fields) {
+                        FieldTable::Definition def = {simp, table.leaves, f.second.body, nullptr};
+                        table.fields[f.first].push_back(def);
+                    }
+                } else if (auto *comp = dynamic_cast<HeapComprehensionObject*>(curr)) {
+                    for (const auto &f : comp->compValues) {
+                        FieldTable::Definition def = {comp, table.leaves, nullptr, f.second};
+                        table.fields[f.first].push_back(def);
+                    }
+                }
+                table.leaves++;
+            }
+            return true;
+        }
+
+        /** The object's flattened fields, built if it has not been indexed before.
+         *
+         * \param obj The object.
+         * \returns The table, or nullptr if the object has to be searched with findObject.
+         */
+        const FieldTable *fieldTable(HeapObject *obj)
+        {
+            // A leaf's fields are found directly, a table would only double its size.
+            if (dynamic_cast<HeapExtendedObject*>(obj) == nullptr) return nullptr;
+            if (obj->fieldTable == nullptr) {
+                obj->fieldTable.reset(new FieldTable());
+                if (!flattenObject(obj, *obj->fieldTable)) {
+                    obj->fieldTable->flat = false;
+                    obj->fieldTable->fields.clear();
+                }
+            }
+            return obj->fieldTable->flat ? obj->fieldTable.get() : nullptr;
+        }
+
         typedef std::map<const Identifier*, Object::Field::Hide> IdHideMap;
 
         /** Auxiliary function.
@@ -637,7 +851,8 @@ namespace {
         /** Import another Jsonnet file.
          *
          * If the file has already been imported, then use that version.  This maintains
-         * referential transparency in the case of writes to disk during execution.
+         * referential transparency in the case of writes to disk during execution.  Each version
+         * of a file is only parsed once in the process, \see ImportCache.
          *
          * \param loc Location of the import statement.
          * \param file Path to the filename.
@@ -645,15 +860,18 @@ namespace {
         AST *import(const LocationRange &loc, const std::string &file)
         {
             std::string dir = dir_name(loc.file);
-            const std::string *input = importString(loc, file);
 
-            std::string abs_file = file;
-            if (dir.length() > 0)
-                abs_file = dir + abs_file;
+            std::shared_ptr<const ParsedImport> &parsed = parsedImports[{dir, file}];
+            if (parsed == nullptr) {
+                const std::string *input = importString(loc, file);
 
-            auto *expr = jsonnet_parse(alloc, abs_file, input->c_str());
-            jsonnet_static_analysis(expr);
-            return expr;
+                std::string abs_file = file;
+                if (dir.length() > 0)
+                    abs_file = dir + abs_file;
+
+                parsed = import_cache().parse(abs_file, *input);
+            }
+            return parsed->expr;
         }
 
         /** Import a file as a string.
@@ -713,7 +931,9 @@ namespace {
          */
         unsigned countLeaves(HeapObject *obj)
         {
-            if (auto *ext = dynamic_cast<HeapExtendedObject*>(obj)) {
+            if (obj->fieldTable != nullptr && obj->fieldTable->flat) {
+                return obj->fieldTable->leaves;
+            } else if (auto *ext = dynamic_cast<HeapExtendedObject*>(obj)) {
                 return countLeaves(ext->left) + countLeaves(ext->right);
             } else if (auto *super = dynamic_cast<HeapSuperObject*>(obj)) {
                 return countLeaves(super->root);
@@ -774,22 +994,24 @@ namespace {
                 case Value::ARRAY: {
                     auto *arr_a = static_cast<HeapArray*>(a.v.h);
                     auto *arr_b = static_cast<HeapArray*>(b.v.h);
-                    if (arr_a->elements.size() != arr_b->elements.size()) return false;
-                    for (unsigned long i=0 ; i<arr_a->elements.size() ; ++i) {
-                        auto th_a = arr_a->elements[i];
+                    if (arr_a->length() != arr_b->length()) return false;
+                    for (unsigned long i=0 ; i<arr_a->length() ; ++i) {
+                        auto th_a = arr_a->elements()[i];
                         if (!th_a->filled) {
                             stack.newCall(loc, th_a, th_a->self, th_a->offset, th_a->upValues);
                             evaluate(th_a->body);
                             stack.pop();
                             th_a->fill(scratch);
+                            heap.writeBarrier(th_a);
                         }
 
-                        auto th_b = arr_b->elements[i];
+                        auto th_b = arr_b->elements()[i];
                         if (!th_b->filled) {
                             stack.newCall(loc, th_b, th_b->self, th_b->offset, th_b->upValues);
                             evaluate(th_b->body);
                             stack.pop();
                             th_b->fill(scratch);
+                            heap.writeBarrier(th_b);
                         }
 
                         if (!equality(loc, th_a->content, th_b->content))
@@ -846,7 +1068,7 @@ namespace {
                 case Value::STRING: {
                     auto *str_a = static_cast<HeapString*>(a.v.h);
                     auto *str_b = static_cast<HeapString*>(b.v.h);
-                    return str_a->value == str_b->value;
+                    return str_a->length == str_b->length && str_a->value() == str_b->value();
                 }
 
             }
@@ -889,7 +1111,9 @@ namespace {
 
         std::string toString(const LocationRange &loc)
         {
-            return manifestJson(loc, false, "");
+            ManifestOutput out;
+            manifestJson(loc, false, "", out);
+            return out.buf;
         }
 
 
@@ -903,26 +1127,45 @@ namespace {
         const AST *objectIndex(const LocationRange &loc, HeapObject *obj,
                                const Identifier *f)
         {
-            unsigned found_at = 0;
-            HeapObject *self = nullptr;
-            HeapLeafObject *found = findObject(f, obj, obj, 0, found_at, self);
-            if (found == nullptr) {
-                throw makeError(loc, "Field does not exist: " + f->name);
+            // Indexing a super object looks for fields in its root, skipping some leaves.
+            HeapObject *root = obj;
+            unsigned start_from = 0;
+            if (auto *super = dynamic_cast<HeapSuperObject*>(obj)) {
+                root = super->root;
+                start_from = super->offset;
             }
-            if (auto *simp = dynamic_cast<HeapSimpleObject*>(found)) {
-                auto it = simp->fields.find(f);
-                const AST *body = it->second.body;
 
-                stack.newCall(loc, simp, self, found_at, simp->upValues);
-                return body;
+            HeapObject *self = root;
+            FieldTable::Definition found = {nullptr, 0, nullptr, nullptr};
+            if (const FieldTable *table = fieldTable(root)) {
+                auto it = table->fields.find(f);
+                if (it != table->fields.end()) {
+                    const auto &defs = it->second;
+                    auto def = std::lower_bound(defs.begin(), defs.end(), start_from,
+                        [](const FieldTable::Definition &d, unsigned c) { return d.counter < c; });
+                    if (def != defs.end()) found = *def;
+                }
+            } else {
+                self = nullptr;
+                found.leaf = findObject(f, obj, obj, 0, found.counter, self);
+                if (auto *simp = dynamic_cast<HeapSimpleObject*>(found.leaf)) {
+                    found.body = simp->fields.find(f)->second.body;
+                } else if (auto *comp = dynamic_cast<HeapComprehensionObject*>(found.leaf)) {
+                    found.thunk = comp->compValues.find(f)->second;
+                }
+            }
+            if (found.leaf == nullptr) {
+                throw makeError(loc, "Field does not exist: " + f->name);
+            }
+            if (auto *simp = dynamic_cast<HeapSimpleObject*>(found.leaf)) {
+                stack.newCall(loc, simp, self, found.counter, simp->upValues);
+                return found.body;
             } else {
                 // If a HeapLeafObject is not HeapSimpleObject, it must be HeapComprehensionObject.
-                auto *comp = static_cast<HeapComprehensionObject*>(found);
-                auto it = comp->compValues.find(f);
-                auto *th = it->second;
+                auto *comp = static_cast<HeapComprehensionObject*>(found.leaf);
                 BindingFrame binds = comp->upValues;
-                binds[comp->id] = th;
-                stack.newCall(loc, comp, self, found_at, binds);
+                binds[comp->id] = found.thunk;
+                stack.newCall(loc, comp, self, found.counter, binds);
                 return comp->value;
             }
         }
@@ -959,11 +1202,13 @@ namespace {
                     unsigned offset;
                     stack.getSelfBinding(self, offset);
                     scratch = makeArray({});
-                    auto &elements = static_cast<HeapArray*>(scratch.v.h)->elements;
+                    auto &elements = static_cast<HeapArray*>(scratch.v.h)->elements();
                     for (const AST *el : ast.elements) {
                         auto *el_th = makeHeap<HeapThunk>(idArrayElement, self, offset, el);
                         el_th->upValues =  capture(el->freeVariables);
+                        heap.writeBarrier(el_th);
                         elements.push_back(el_th);
+                        heap.writeBarrier(scratch.v.h);
                     }
                 } break;
 
@@ -1041,6 +1286,7 @@ namespace {
                     for (const auto &bind : ast.binds) {
                         auto *thunk = f.bindings[bind.first];
                         thunk->upValues = capture(bind.second->freeVariables);
+                        heap.writeBarrier(thunk);
                     }
                     ast_ = ast.body;
                     goto recurse;
@@ -1167,6 +1413,7 @@ namespace {
                             stack.getSelfBinding(self, offset);
                             auto *thunk = makeHeap<HeapThunk>(func->params[i], self, offset, arg);
                             thunk->upValues = capture(arg->freeVariables);
+                            heap.writeBarrier(thunk);
                             f.thunks.push_back(thunk);
                         }
                         // Popping stack frame invalidates the f reference.
@@ -1266,12 +1513,7 @@ namespace {
                             if (ast.op == BOP_PLUS) {
                                 auto *arr_l = static_cast<HeapArray*>(lhs.v.h);
                                 auto *arr_r = static_cast<HeapArray*>(rhs.v.h);
-                                std::vector<HeapThunk*> elements;
-                                for (auto *el : arr_l->elements)
-                                    elements.push_back(el);
-                                for (auto *el : arr_r->elements)
-                                    elements.push_back(el);
-                                scratch = makeArray(elements);
+                                scratch = makeConcat(arr_l, arr_r);
                             } else {
                                 throw makeError(ast.location,
                                                 "Binary operator " + bop_string(ast.op)
@@ -1393,14 +1635,11 @@ namespace {
 
                             case Value::STRING: {
                                 const std::string &lhs_str =
-                                    static_cast<HeapString*>(lhs.v.h)->value;
+                                    static_cast<HeapString*>(lhs.v.h)->value();
                                 const std::string &rhs_str =
-                                    static_cast<HeapString*>(rhs.v.h)->value;
+                                    static_cast<HeapString*>(rhs.v.h)->value();
+                                // String + is handled by FRAME_STRING_CONCAT.
                                 switch (ast.op) {
-                                    case BOP_PLUS:
-                                    scratch = makeString(lhs_str + rhs_str);
-                                    break;
-
                                     case BOP_LESS_EQ:
                                     scratch = makeBoolean(lhs_str <= rhs_str);
                                     break;
@@ -1436,13 +1675,13 @@ namespace {
                                             "filter function must return boolean, got: "
                                             + type_str(scratch));
                         }
-                        if (scratch.v.b) f.thunks.push_back(arr->elements[f.elementId]);
+                        if (scratch.v.b) f.thunks.push_back(arr->elements()[f.elementId]);
                         f.elementId++;
                         // Iterate through arr, calling the function on each.
-                        if (f.elementId == arr->elements.size()) {
+                        if (f.elementId == arr->length()) {
                             scratch = makeArray(f.thunks);
                         } else {
-                            auto *thunk = arr->elements[f.elementId];
+                            auto *thunk = arr->elements()[f.elementId];
                             BindingFrame bindings = func->upValues;
                             bindings[func->params[0]] = thunk;
                             stack.newCall(ast.location, func, func->self, func->offset, bindings);
@@ -1492,6 +1731,7 @@ namespace {
                                                                        0, nullptr);
                                         el->fill(makeDouble(i));  // i guaranteed not to be inf/NaN
                                         th->upValues[func->params[0]] = el;
+                                        heap.writeBarrier(th);
                                         elements[i] = th;
                                     }
                                     scratch = makeArray(elements);
@@ -1591,7 +1831,7 @@ namespace {
                                     if (func->params.size() != 1) {
                                         throw makeError(loc, "filter function takes 1 parameter.");
                                     }
-                                    if (arr->elements.size() == 0) {
+                                    if (arr->length() == 0) {
                                         scratch = makeArray({});
                                     } else {
                                         f.kind = FRAME_BUILTIN_FILTER;
@@ -1600,7 +1840,7 @@ namespace {
                                         f.thunks.clear();
                                         f.elementId = 0;
 
-                                        auto *thunk = arr->elements[f.elementId];
+                                        auto *thunk = arr->elements()[f.elementId];
                                         BindingFrame bindings = func->upValues;
                                         bindings[func->params[0]] = thunk;
                                         stack.newCall(loc, func, func->self, func->offset,
@@ -1617,7 +1857,7 @@ namespace {
                                     const auto *str = static_cast<const HeapString*>(args[1].v.h);
                                     bool found = false;
                                     for (const auto &field : objectFields(obj, true)) {
-                                        if (field->name == str->value) {
+                                        if (field->name == str->value()) {
                                             found = true;
                                             break;
                                         }
@@ -1639,12 +1879,12 @@ namespace {
 
                                         case Value::ARRAY:
                                         scratch = makeDouble(static_cast<HeapArray*>(e)
-                                                             ->elements.size());
+                                                             ->length());
                                         break;
 
                                         case Value::STRING:
                                         scratch = makeDouble(static_cast<HeapString*>(e)
-                                                             ->value.length());
+                                                             ->length);
                                         break;
 
                                         case Value::FUNCTION:
@@ -1668,26 +1908,28 @@ namespace {
                                         fields.insert(field->name);
                                     }
                                     scratch = makeArray({});
-                                    auto &elements = static_cast<HeapArray*>(scratch.v.h)->elements;
+                                    auto &elements = static_cast<HeapArray*>(scratch.v.h)->elements();
                                     for (const auto &field : fields) {
                                         auto *th = makeHeap<HeapThunk>(idArrayElement, nullptr,
                                                                        0, nullptr);
                                         elements.push_back(th);
+                                        heap.writeBarrier(scratch.v.h);
                                         th->fill(makeString(field));
+                                        heap.writeBarrier(th);
                                     }
                                 } break;
 
                                 case 16: { // codepoint
                                     validateBuiltinArgs(loc, builtin, args, {Value::STRING});
                                     const std::string &str =
-                                        static_cast<HeapString*>(args[0].v.h)->value;
+                                        static_cast<HeapString*>(args[0].v.h)->value();
                                     if (str.length() != 1) {
                                         std::stringstream ss;
                                         ss << "codepoint takes a string of length 1, got length "
                                            << str.length();
                                         throw makeError(loc, ss.str());
                                     }
-                                    char c = static_cast<HeapString*>(args[0].v.h)->value[0];
+                                    char c = static_cast<HeapString*>(args[0].v.h)->value()[0];
                                     scratch = makeDouble((unsigned char)(c));
                                 } break;
 
@@ -1745,7 +1987,7 @@ namespace {
 
                                 case 23: {  // extVar
                                     validateBuiltinArgs(loc, builtin, args, {Value::STRING});
-                                    const std::string &var = static_cast<HeapString*>(args[0].v.h)->value;
+                                    const std::string &var = static_cast<HeapString*>(args[0].v.h)->value();
                                     if (externalVars.find(var) == externalVars.end()) {
                                         throw makeError(ast.location, "Undefined external variable: " + var);
                                     }
@@ -1772,6 +2014,7 @@ namespace {
                         if (auto *thunk = dynamic_cast<HeapThunk*>(f.context)) {
                             // If we called a thunk, cache result.
                             thunk->fill(scratch);
+                            heap.writeBarrier(thunk);
                         } else if (auto *closure = dynamic_cast<HeapClosure*>(f.context)) {
                             if (f.elementId < f.thunks.size()) {
                                 // If tailstrict, force thunks
@@ -1808,7 +2051,7 @@ namespace {
                         if (scratch.t != Value::STRING)
                             throw makeError(ast.location, "Error message must be string, got " +
                                                           type_str(scratch) + ".");
-                        throw makeError(ast.location, static_cast<HeapString*>(scratch.v.h)->value);
+                        throw makeError(ast.location, static_cast<HeapString*>(scratch.v.h)->value());
                     } break;
 
                     case FRAME_IF: {
@@ -1832,14 +2075,14 @@ namespace {
                                                               + type_str(scratch) + ".");
                             }
                             long i = long(scratch.v.d);
-                            long sz = array->elements.size();
+                            long sz = array->length();
                             if (i < 0 || i >= sz) {
                                 std::stringstream ss;
                                 ss << "Array bounds error: " << i
                                    << " not within [0, " << sz << ")";
                                 throw makeError(ast.location, ss.str());
                             }
-                            auto *thunk = array->elements[i];
+                            auto *thunk = array->elements()[i];
                             if (thunk->filled) {
                                 scratch = thunk->content;
                             } else {
@@ -1858,7 +2101,7 @@ namespace {
                                                 + type_str(scratch) + ".");
                             }
                             const std::string &index_name =
-                                static_cast<HeapString*>(scratch.v.h)->value;
+                                static_cast<HeapString*>(scratch.v.h)->value();
                             auto *fid = alloc->makeIdentifier(index_name);
                             stack.pop();
                             ast_ = objectIndex(ast.location, obj, fid);
@@ -1872,7 +2115,7 @@ namespace {
                                                 + type_str(scratch) + ".");
                             }
                             // TODO(dcunnin):  UTF-8 support goes here.
-                            long sz = obj->value.length();
+                            long sz = obj->length;
                             long i = (long)scratch.v.d;
                             if (i < 0 || i >= sz) {
                                 std::stringstream ss;
@@ -1880,7 +2123,7 @@ namespace {
                                    << " not within [0, " << sz << ")";
                                 throw makeError(ast.location, ss.str());
                             }
-                            char ch[] = {obj->value[i], '\0'};
+                            char ch[] = {obj->value()[i], '\0'};
                             scratch = makeString(ch);
                         } else {
                             std::cerr << "INTERNAL ERROR: Not object / array / string."
@@ -1914,7 +2157,7 @@ namespace {
                             if (scratch.t != Value::STRING) {
                                 throw makeError(ast.location, "Field name was not a string.");
                             }
-                            const auto &fname = static_cast<const HeapString*>(scratch.v.h)->value;
+                            const auto &fname = static_cast<const HeapString*>(scratch.v.h)->value();
                             const Identifier *fid = alloc->makeIdentifier(fname);
                             if (f.objectFields.find(fid) != f.objectFields.end()) {
                                 throw makeError(ast.location,
@@ -1942,14 +2185,14 @@ namespace {
                                             + type_str(arr_v));
                         }
                         const auto *arr = static_cast<const HeapArray*>(arr_v.v.h);
-                        if (arr->elements.size() == 0) {
+                        if (arr->length() == 0) {
                             // Degenerate case.  Just create the object now.
                             scratch = makeObject<HeapComprehensionObject>(BindingFrame{}, ast.value,
                                                                           ast.id, BindingFrame{});
                         } else {
                             f.kind = FRAME_OBJECT_COMP_ELEMENT;
                             f.val = scratch;
-                            f.bindings[ast.id] = arr->elements[0];
+                            f.bindings[ast.id] = arr->elements()[0];
                             f.elementId = 0;
                             ast_ = ast.field;
                             goto recurse;
@@ -1964,21 +2207,21 @@ namespace {
                             ss << "field must be string, got: " << type_str(scratch);
                             throw makeError(ast.location, ss.str());
                         }
-                        const auto &fname = static_cast<const HeapString*>(scratch.v.h)->value;
+                        const auto &fname = static_cast<const HeapString*>(scratch.v.h)->value();
                         const Identifier *fid = alloc->makeIdentifier(fname);
                         if (f.elements.find(fid) != f.elements.end()) {
                             throw makeError(ast.location,
                                             "Duplicate field name: \"" + fname + "\"");
                         }
-                        f.elements[fid] = arr->elements[f.elementId];
+                        f.elements[fid] = arr->elements()[f.elementId];
                         f.elementId++;
 
-                        if (f.elementId == arr->elements.size()) {
+                        if (f.elementId == arr->length()) {
                             auto env = capture(ast.freeVariables);
                             scratch = makeObject<HeapComprehensionObject>(env, ast.value,
                                                                           ast.id, f.elements);
                         } else {
-                            f.bindings[ast.id] = arr->elements[f.elementId];
+                            f.bindings[ast.id] = arr->elements()[f.elementId];
                             ast_ = ast.field;
                             goto recurse;
                         }
@@ -1986,22 +2229,20 @@ namespace {
 
                     case FRAME_STRING_CONCAT: {
                         const auto &ast = *static_cast<const Binary*>(f.ast);
-                        const Value &lhs = stack.top().val;
-                        const Value &rhs = stack.top().val2;
-                        std::stringstream ss;
-                        if (lhs.t == Value::STRING) {
-                            ss << static_cast<const HeapString*>(lhs.v.h)->value;
-                        } else {
-                            scratch = lhs;
-                            ss << toString(ast.left->location);
+                        // Convert whichever side is not a string.  The result replaces it on the
+                        // stack so that it is not collected.
+                        if (stack.top().val.t != Value::STRING) {
+                            scratch = stack.top().val;
+                            Value lhs_str = makeString(toString(ast.left->location));
+                            stack.top().val = lhs_str;
                         }
-                        if (rhs.t == Value::STRING) {
-                            ss << static_cast<const HeapString*>(rhs.v.h)->value;
-                        } else {
-                            scratch = rhs;
-                            ss << toString(ast.right->location);
+                        if (stack.top().val2.t != Value::STRING) {
+                            scratch = stack.top().val2;
+                            Value rhs_str = makeString(toString(ast.right->location));
+                            stack.top().val2 = rhs_str;
                         }
-                        scratch = makeString(ss.str());
+                        scratch = makeConcat(static_cast<HeapString*>(stack.top().val.v.h),
+                                             static_cast<HeapString*>(stack.top().val2.v.h));
                     } break;
 
                     case FRAME_UNARY: {
@@ -2058,29 +2299,44 @@ namespace {
             }
         }
 
+        /** Pass the output on to its callback if it has grown large enough.
+         *
+         * \param final Whether to pass it on however small it is.
+         */
+        void flushOutput(const LocationRange &loc, ManifestOutput &out, bool final)
+        {
+            if (!out.flush(final)) {
+                throw makeError(loc, "Could not write output.");
+            }
+        }
+
         /** Manifest the scratch value by evaluating any remaining fields, and then convert to JSON.
          *
          * This can trigger a garbage collection cycle.  Be sure to stash any objects that aren't
          * reachable via the stack or heap.
          *
+         * The JSON is written straight to the output, without building a string for each nested
+         * array or object.
+         *
          * \param multiline If true, will print objects and arrays in an indented fashion.
+         * \param out Where to write the JSON.
          */
-        std::string manifestJson(const LocationRange &loc, bool multiline,
-                                 const std::string &indent)
+        void manifestJson(const LocationRange &loc, bool multiline, const std::string &indent,
+                          ManifestOutput &out)
         {
             // Printing fields means evaluating and binding them, which can trigger
             // garbage collection.
 
-            std::stringstream ss;
+            std::string &buf = out.buf;
             switch (scratch.t) {
                 case Value::ARRAY: {
                     HeapArray *arr = static_cast<HeapArray*>(scratch.v.h);
-                    if (arr->elements.size() == 0) {
-                        ss << "[ ]";
+                    if (arr->length() == 0) {
+                        buf += "[ ]";
                     } else {
                         const char *prefix = multiline ? "[\n" : "[";
                         std::string indent2 = multiline ? indent + "   " : indent;
-                        for (auto *thunk : arr->elements) {
+                        for (auto *thunk : arr->elements()) {
                             LocationRange tloc = thunk->body == nullptr
                                                ? loc
                                                : thunk->body->location;
@@ -2096,31 +2352,35 @@ namespace {
                                 stack.top().val = scratch;
                                 evaluate(thunk->body);
                             }
-                            auto element = manifestJson(tloc, multiline, indent2);
+                            buf += prefix;
+                            buf += indent2;
+                            manifestJson(tloc, multiline, indent2, out);
                             // Restore scratch
                             scratch = stack.top().val;
                             stack.pop();
-                            ss << prefix << indent2 << element;
                             prefix = multiline ? ",\n" : ", ";
+                            flushOutput(loc, out, false);
                         }
-                        ss << (multiline ? "\n" : "") << indent << "]";
+                        if (multiline) buf += "\n";
+                        buf += indent;
+                        buf += "]";
                     }
                 }
                 break;
 
                 case Value::BOOLEAN:
-                ss << (scratch.v.b ? "true" : "false");
+                buf += scratch.v.b ? "true" : "false";
                 break;
 
                 case Value::DOUBLE:
-                ss << jsonnet_unparse_number(scratch.v.d);
+                buf += jsonnet_unparse_number(scratch.v.d);
                 break;
 
                 case Value::FUNCTION:
                 throw makeError(loc, "Couldn't manifest function in JSON output.");
 
                 case Value::NULL_TYPE:
-                ss << "null";
+                buf += "null";
                 break;
 
                 case Value::OBJECT: {
@@ -2132,7 +2392,7 @@ namespace {
                         fields[f->name] = f;
                     }
                     if (fields.size() == 0) {
-                        ss << "{ }";
+                        buf += "{ }";
                     } else {
                         std::string indent2 = multiline ? indent + "   " : indent;
                         const char *prefix = multiline ? "{\n" : "{";
@@ -2141,41 +2401,174 @@ namespace {
                             const AST *body = objectIndex(loc, obj, f.second);
                             stack.top().val = scratch;
                             evaluate(body);
-                            auto vstr = manifestJson(body->location, multiline, indent2);
+                            buf += prefix;
+                            buf += indent2;
+                            buf += "\"";
+                            buf += f.first;
+                            buf += "\": ";
+                            manifestJson(body->location, multiline, indent2, out);
                             // Reset scratch so that the object we're manifesting doesn't
                             // get GC'd.
                             scratch = stack.top().val;
                             stack.pop();
-                            ss << prefix << indent2 << "\"" << f.first << "\": " << vstr;
                             prefix = multiline ? ",\n" : ", ";
+                            flushOutput(loc, out, false);
                         }
-                        ss << (multiline ? "\n" : "") << indent << "}";
+                        if (multiline) buf += "\n";
+                        buf += indent;
+                        buf += "}";
                     }
                 }
                 break;
 
                 case Value::STRING: {
-                    const std::string &str = static_cast<HeapString*>(scratch.v.h)->value;
-                    ss << jsonnet_unparse_escape(str);
+                    const std::string &str = static_cast<HeapString*>(scratch.v.h)->value();
+                    buf += jsonnet_unparse_escape(str);
                 }
                 break;
             }
-            return ss.str();
         }
 
-        std::string manifestString(const LocationRange &loc)
+        void manifestString(const LocationRange &loc, ManifestOutput &out)
         {
             if (scratch.t != Value::STRING) {
                 std::stringstream ss;
                 ss << "Expected string result, got: " << type_str(scratch.t);
                 throw makeError(loc, ss.str());
             }
-            return static_cast<HeapString*>(scratch.v.h)->value;
+            out.buf += static_cast<HeapString*>(scratch.v.h)->value();
         }
 
-        StrMap manifestMulti(bool string)
+        /** Manifest the scratch value as the program's output.
+         *
+         * \param string Whether to expect a string and output it without JSON encoding.
+         */
+        void manifest(bool string, ManifestOutput &out)
+        {
+            LocationRange loc("During manifestation");
+            if (string) {
+                manifestString(loc, out);
+            } else {
+                manifestJson(loc, true, "", out);
+            }
+            flushOutput(loc, out, true);
+        }
+
+        /** Raise an error if a visitor callback failed.
+         *
+         * \param status What the callback returned.
+         */
+        void visited(const LocationRange &loc, int status)
+        {
+            if (status != 0) {
+                throw makeError(loc, "Could not visit output.");
+            }
+        }
+
+        /** Manifest the scratch value by evaluating any remaining fields, and pass it to the
+         * visitor.
+         *
+         * This walks the value in the same way as manifestJson, so the same care must be taken
+         * over garbage collection.
+         */
+        void manifestVisit(const LocationRange &loc, const JsonnetJsonVisitor &visitor, void *ctx)
+        {
+            switch (scratch.t) {
+                case Value::ARRAY: {
+                    HeapArray *arr = static_cast<HeapArray*>(scratch.v.h);
+                    visited(loc, visitor.array_begin(ctx));
+                    for (auto *thunk : arr->elements()) {
+                        LocationRange tloc = thunk->body == nullptr
+                                           ? loc
+                                           : thunk->body->location;
+                        if (thunk->filled) {
+                            stack.newCall(loc, thunk, nullptr, 0, BindingFrame{});
+                            // Keep arr alive when scratch is overwritten
+                            stack.top().val = scratch;
+                            scratch = thunk->content;
+                        } else {
+                            stack.newCall(loc, thunk,
+                                          thunk->self, thunk->offset, thunk->upValues);
+                            // Keep arr alive when scratch is overwritten
+                            stack.top().val = scratch;
+                            evaluate(thunk->body);
+                        }
+                        manifestVisit(tloc, visitor, ctx);
+                        // Restore scratch
+                        scratch = stack.top().val;
+                        stack.pop();
+                    }
+                    visited(loc, visitor.array_end(ctx));
+                }
+                break;
+
+                case Value::BOOLEAN:
+                visited(loc, visitor.boolean(ctx, scratch.v.b));
+                break;
+
+                case Value::DOUBLE:
+                visited(loc, visitor.number(ctx, scratch.v.d));
+                break;
+
+                case Value::FUNCTION:
+                throw makeError(loc, "Couldn't manifest function in JSON output.");
+
+                case Value::NULL_TYPE:
+                visited(loc, visitor.null_value(ctx));
+                break;
+
+                case Value::OBJECT: {
+                    auto *obj = static_cast<HeapObject*>(scratch.v.h);
+                    std::map<std::string, const Identifier*> fields;
+                    for (const auto &f : objectFields(obj, true)) {
+                        fields[f->name] = f;
+                    }
+                    visited(loc, visitor.object_begin(ctx));
+                    for (const auto &f : fields) {
+                        // pushes FRAME_CALL
+                        const AST *body = objectIndex(loc, obj, f.second);
+                        stack.top().val = scratch;
+                        evaluate(body);
+                        visited(loc, visitor.object_key(ctx, f.first.data(), f.first.length()));
+                        manifestVisit(body->location, visitor, ctx);
+                        // Reset scratch so that the object we're manifesting doesn't
+                        // get GC'd.
+                        scratch = stack.top().val;
+                        stack.pop();
+                    }
+                    visited(loc, visitor.object_end(ctx));
+                }
+                break;
+
+                case Value::STRING: {
+                    const std::string &str = static_cast<HeapString*>(scratch.v.h)->value();
+                    visited(loc, visitor.string(ctx, str.data(), str.length()));
+                }
+                break;
+            }
+        }
+
+        /** Pass the scratch value to the visitor as the program's output.
+         *
+         * \param string Whether to expect a string.
+         */
+        void manifestVisit(bool string, const JsonnetJsonVisitor &visitor, void *ctx)
+        {
+            LocationRange loc("During manifestation");
+            if (string && scratch.t != Value::STRING) {
+                std::stringstream ss;
+                ss << "Expected string result, got: " << type_str(scratch.t);
+                throw makeError(loc, ss.str());
+            }
+            manifestVisit(loc, visitor, ctx);
+        }
+
+        /** The files to manifest in multi mode, from the top-level object in scratch.
+         *
+         * \returns The fields of the object, in alphabetical order.
+         */
+        std::vector<std::pair<std::string, const Identifier*>> multiFiles()
         {
-            StrMap r;
             LocationRange loc("During manifestation");
             if (scratch.t != Value::OBJECT) {
                 std::stringstream ss;
@@ -2189,18 +2582,40 @@ namespace {
             for (const auto &f : objectFields(obj, true)) {
                 fields[f->name] = f;
             }
-            for (const auto &f : fields) {
-                // pushes FRAME_CALL
-                const AST *body = objectIndex(loc, obj, f.second);
-                stack.top().val = scratch;
-                evaluate(body);
-                auto vstr = string ? manifestString(body->location)
-                                   : manifestJson(body->location, true, "");
-                // Reset scratch so that the object we're manifesting doesn't
-                // get GC'd.
-                scratch = stack.top().val;
-                stack.pop();
-                r[f.first] = vstr;
+            return std::vector<std::pair<std::string, const Identifier*>>(fields.begin(),
+                                                                          fields.end());
+        }
+
+        /** Manifest one field of the top-level object in scratch as the content of a file.
+         *
+         * \param field One of the fields returned by multiFiles.
+         */
+        std::string manifestFile(const Identifier *field, bool string)
+        {
+            LocationRange loc("During manifestation");
+            auto *obj = static_cast<HeapObject*>(scratch.v.h);
+            // pushes FRAME_CALL
+            const AST *body = objectIndex(loc, obj, field);
+            stack.top().val = scratch;
+            evaluate(body);
+            ManifestOutput out;
+            if (string) {
+                manifestString(body->location, out);
+            } else {
+                manifestJson(body->location, true, "", out);
+            }
+            // Reset scratch so that the object we're manifesting doesn't
+            // get GC'd.
+            scratch = stack.top().val;
+            stack.pop();
+            return out.buf;
+        }
+
+        StrMap manifestMulti(bool string)
+        {
+            StrMap r;
+            for (const auto &f : multiFiles()) {
+                r[f.first] = manifestFile(f.second, string);
             }
             return r;
         }
@@ -2219,21 +2634,106 @@ std::string jsonnet_vm_execute(Allocator *alloc, const AST *ast,
     Interpreter vm(alloc, ext_vars, max_stack, gc_min_objects, gc_growth_trigger,
                    import_callback, ctx);
     vm.evaluate(ast);
-    if (string_output) {
-        return vm.manifestString(LocationRange("During manifestation"));
-    } else {
-        return vm.manifestJson(LocationRange("During manifestation"), true, "");
-    }
+    ManifestOutput out;
+    vm.manifest(string_output, out);
+    return out.buf;
+}
+
+void jsonnet_vm_execute_stream(Allocator *alloc, const AST *ast, const StrMap &ext_vars,
+                               unsigned max_stack, double gc_min_objects,
+                               double gc_growth_trigger,
+                               JsonnetImportCallback *import_callback, void *ctx,
+                               bool string_output,
+                               JsonnetOutputCallback *output_callback, void *output_ctx)
+{
+    Interpreter vm(alloc, ext_vars, max_stack, gc_min_objects, gc_growth_trigger,
+                   import_callback, ctx);
+    vm.evaluate(ast);
+    ManifestOutput out(output_callback, output_ctx);
+    vm.manifest(string_output, out);
+}
+
+void jsonnet_vm_execute_visit(Allocator *alloc, const AST *ast, const StrMap &ext_vars,
+                              unsigned max_stack, double gc_min_objects,
+                              double gc_growth_trigger,
+                              JsonnetImportCallback *import_callback, void *ctx,
+                              bool string_output,
+                              const JsonnetJsonVisitor &visitor, void *visitor_ctx)
+{
+    Interpreter vm(alloc, ext_vars, max_stack, gc_min_objects, gc_growth_trigger,
+                   import_callback, ctx);
+    vm.evaluate(ast);
+    vm.manifestVisit(string_output, visitor, visitor_ctx);
 }
 
 StrMap jsonnet_vm_execute_multi(Allocator *alloc, const AST *ast, const StrMap &ext_vars,
                                 unsigned max_stack, double gc_min_objects, double gc_growth_trigger,
                                 JsonnetImportCallback *import_callback, void *ctx,
-                                bool string_output)
+                                bool string_output, unsigned max_threads)
 {
     Interpreter vm(alloc, ext_vars, max_stack, gc_min_objects, gc_growth_trigger,
                    import_callback, ctx);
     vm.evaluate(ast);
-    return vm.manifestMulti(string_output);
-}
+    auto files = vm.multiFiles();
+    unsigned num_threads = std::min<size_t>(max_threads, files.size());
+    if (num_threads <= 1) {
+        return vm.manifestMulti(string_output);
+    }
 
+    // Nothing on a heap can be shared between threads, so each thread evaluates the program
+    // again with an interpreter of its own, and then takes the next file to manifest until
+    // there are none left.  Only the ASTs are shared.
+    std::vector<std::string> contents(files.size());
+    std::vector<std::exception_ptr> errors(files.size());
+    std::exception_ptr interpreter_error;
+    std::mutex interpreter_error_mutex;
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+
+    auto manifest_files = [&] (Interpreter &interpreter) {
+        // A file that has been taken is always finished, so if several files have errors, the
+        // first of them is known about.
+        while (!failed) {
+            size_t i = next++;
+            if (i >= files.size()) break;
+            try {
+                contents[i] = interpreter.manifestFile(files[i].second, string_output);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1 ; t < num_threads ; ++t) {
+        threads.emplace_back([&] () {
+            try {
+                Interpreter interpreter(alloc, ext_vars, max_stack, gc_min_objects,
+                                        gc_growth_trigger, import_callback, ctx);
+                interpreter.evaluate(ast);
+                manifest_files(interpreter);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(interpreter_error_mutex);
+                if (interpreter_error == nullptr) interpreter_error = std::current_exception();
+                failed = true;
+            }
+        });
+    }
+    manifest_files(vm);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Report the same error as manifesting the files one at a time would have.
+    for (const auto &error : errors) {
+        if (error != nullptr) std::rethrow_exception(error);
+    }
+    if (interpreter_error != nullptr) std::rethrow_exception(interpreter_error);
+
+    StrMap r;
+    for (size_t i = 0 ; i < files.size() ; ++i) {
+        r[files[i].first].swap(contents[i]);
+    }
+    return r;
+}
@@ -61,6 +61,54 @@ std::string jsonnet_vm_execute(Allocator *alloc, const AST *ast,
                                JsonnetImportCallback *import_callback, void *import_callback_ctx,
                                bool string_output);
 
+/** Execute the program and pass the value as JSON to a callback as it is produced.
+ *
+ * The JSON is passed to the callback in pieces, so it is never all held in memory.
+ *
+ * \param alloc The allocator used to create the ast.
+ * \param ast The program to execute.
+ * \param max_stack Recursion beyond this level gives an error.
+ * \param gc_min_objects The garbage collector does not run when the heap is this small.
+ * \param gc_growth_trigger Growth since last garbage collection cycle to trigger a new cycle.
+ * \param import_callback A callback to handle imports
+ * \param import_callback_ctx Context param for the import callback.
+ * \param output_string Whether to expect a string and output it without JSON encoding
+ * \param output_callback Receives the JSON.
+ * \param output_callback_ctx Context param for the output callback.
+ * \throws RuntimeError reports runtime errors in the program, or failure of the callback.  Some
+ * of the JSON may already have been passed to the callback.
+ */
+void jsonnet_vm_execute_stream(Allocator *alloc, const AST *ast,
+                               const std::map<std::string, std::string> &ext_vars,
+                               unsigned max_stack, double gc_min_objects,
+                               double gc_growth_trigger,
+                               JsonnetImportCallback *import_callback, void *import_callback_ctx,
+                               bool string_output,
+                               JsonnetOutputCallback *output_callback, void *output_callback_ctx);
+
+/** Execute the program and pass the value to a visitor, without converting it to JSON text.
+ *
+ * \param alloc The allocator used to create the ast.
+ * \param ast The program to execute.
+ * \param max_stack Recursion beyond this level gives an error.
+ * \param gc_min_objects The garbage collector does not run when the heap is this small.
+ * \param gc_growth_trigger Growth since last garbage collection cycle to trigger a new cycle.
+ * \param import_callback A callback to handle imports
+ * \param import_callback_ctx Context param for the import callback.
+ * \param output_string Whether to expect a string and pass it to the visitor as one
+ * \param visitor Receives the value.
+ * \param visitor_ctx Context param for the visitor.
+ * \throws RuntimeError reports runtime errors in the program, or failure of the visitor.  Some
+ * of the value may already have been passed to the visitor.
+ */
+void jsonnet_vm_execute_visit(Allocator *alloc, const AST *ast,
+                              const std::map<std::string, std::string> &ext_vars,
+                              unsigned max_stack, double gc_min_objects,
+                              double gc_growth_trigger,
+                              JsonnetImportCallback *import_callback, void *import_callback_ctx,
+                              bool string_output,
+                              const JsonnetJsonVisitor &visitor, void *visitor_ctx);
+
 /** Execute the program and return the value as a number of JSON files.
  *
  * This assumes the given program yields an object whose keys are filenames.
@@ -73,6 +121,8 @@ std::string jsonnet_vm_execute(Allocator *alloc, const AST *ast,
  * \param import_callback A callback to handle imports
  * \param import_callback_ctx Context param for the import callback.
  * \param output_string Whether to expect a string and output it without JSON encoding
+ * \param max_threads How many files can be manifested at the same time.  Each thread evaluates the
+ * program with its own heap, so the import callback must be thread safe if this is more than 1.
  * \throws RuntimeError reports runtime errors in the program.
  * \returns A mapping from filename to the JSON strings for that file.
  */
@@ -80,6 +130,6 @@ std::map<std::string, std::string> jsonnet_vm_execute_multi(
     Allocator *alloc, const AST *ast, const std::map<std::string, std::string> &ext_vars,
     unsigned max_stack, double gc_min_objects, double gc_growth_trigger,
     JsonnetImportCallback *import_callback, void *import_callback_ctx,
-    bool string_output);
+    bool string_output, unsigned max_threads);
 
 #endif
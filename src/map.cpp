@@ -13,6 +13,7 @@
 #include "open_gl.hpp"
 
 #include "cacheable_resource.hpp"
+#include "collision_grid.hpp"
 #include "config.hpp"
 #include "dispatcher.hpp"
 #include "engine.hpp"
@@ -21,6 +22,7 @@
 #include "map.hpp"
 #include "map_loader.hpp"
 #include "map_object.hpp"
+#include "map_viewer.hpp"
 #include "object_manager.hpp"
 #include "renderable_component.hpp"
 #include "shader.hpp"
@@ -28,6 +30,7 @@
 #include "tileset.hpp"
 
 Map::Map(const std::string map_src):
+    pathfinder(&collision_grid),
     event_step_on(glm::ivec2(0, 0)),
     event_step_off(glm::ivec2(0, 0))
     {
@@ -65,7 +68,16 @@ Map::Map(const std::string map_src):
         //Get the tilesets
         //TODO: We'll only support one tileset at the moment
         //Get an object list
-        blocker = std::vector<std::vector<int>>(map_width, std::vector<int>(map_height, 0));
+        collision_grid = CollisionGrid(map_width, map_height);
+        if (special_layer_id != -1) {
+            // Only a tile set on the special layer is solid
+            auto special_layer = ObjectManager::get_instance().get_object<Layer>(special_layer_id);
+            for (int y = 0; y < map_height; ++y) {
+                for (int x = 0; x < map_width; ++x) {
+                    collision_grid.set_terrain(x, y, special_layer->get_tile(x, y).second == 1);
+                }
+            }
+        }
 
         //Generate the geometry needed for this map
         init_shaders();
@@ -84,14 +96,7 @@ Map::~Map() {
 }
 
 bool Map::is_walkable(int x_pos, int y_pos) {
-    if (special_layer_id != 0) {
-        // Block only in the case where a tile is set on the special layer
-        auto layer = ObjectManager::get_instance().get_object<Layer>(special_layer_id);
-        if (layer->get_tile(x_pos, y_pos).second == 1) {
-            return false;
-        }
-    }
-    return true;
+    return !collision_grid.in_bounds(x_pos, y_pos) || !collision_grid.is_terrain_solid(x_pos, y_pos);
 }
 
 int Map::get_tile_type(int x, int y) {
@@ -108,8 +113,10 @@ int Map::get_tile_type(int x, int y) {
 
 
 void Map::add_map_object(int object_id) {
-    if(ObjectManager::is_valid_object_id(object_id))
+    if(ObjectManager::is_valid_object_id(object_id)) {
         object_ids.push_back(object_id);
+        MapViewer::invalidate();
+    }
 }
 
 void Map::remove_map_object(int object_id) {
@@ -120,6 +127,7 @@ void Map::remove_map_object(int object_id) {
                 //remove it if its the object
                 if(*it == object_id) {
                     object_ids.erase(it);
+                    MapViewer::invalidate();
                     return;
                 }
             }
@@ -479,49 +487,41 @@ bool Map::init_shaders() {
     return true;
 }
 
-Map::Blocker::Blocker(glm::ivec2 tile, std::vector <std::vector<int>>* blocker):
-    tile(tile), blocker(blocker) {
-        if(tile.x < 0 || tile.y < 0 || tile.x >= (*blocker).size() || tile.y >=(*blocker)[tile.x].size()) {
+Map::Blocker::Blocker(glm::ivec2 tile, CollisionGrid* collision_grid):
+    tile(tile), collision_grid(collision_grid) {
+        if(!collision_grid->block(tile.x, tile.y)) {
             VLOG(2) << "Block level can't be increased at " << tile.x << " " << tile.y
-                    << " as it is off the edge of the map";
+                    << " as it is off the edge of the map or fully blocked";
         } else {
-            (*blocker)[tile.x][tile.y]++;
-
             VLOG(2) << "Block level at tile " << tile.x << " " <<tile.y
-                    << " increased from " << (*blocker)[tile.x][tile.y] - 1
-                    << " to " << (*blocker)[tile.x][tile.y] << ".";
+                    << " increased to " << collision_grid->get_block_count(tile.x, tile.y) << ".";
         }
 }
 
 Map::Blocker::Blocker(const Map::Blocker &other):
-    tile(other.tile), blocker(other.blocker) {
-        if(tile.x < 0 || tile.y < 0 || tile.x >= (*blocker).size() || tile.y >=(*blocker)[tile.x].size()) {
+    tile(other.tile), collision_grid(other.collision_grid) {
+        if(!collision_grid->block(tile.x, tile.y)) {
             VLOG(2) << "Block level can't be increased at " << tile.x << " " << tile.y
-                    << " as it is off the edge of the map";
+                    << " as it is off the edge of the map or fully blocked";
         } else {
-            (*blocker)[tile.x][tile.y]++;
-
             VLOG(2) << "Block level at tile " << tile.x << " " <<tile.y
-                    << " increased from " << (*blocker)[tile.x][tile.y] - 1
-                    << " to " << (*blocker)[tile.x][tile.y] << ".";
+                    << " increased to " << collision_grid->get_block_count(tile.x, tile.y) << ".";
         }
 }
 
 Map::Blocker::~Blocker() {
     VLOG(2) << "Unblocking tile at " << tile.x << ", " << tile.y << ".";
-    if(tile.x < 0 || tile.y < 0 || tile.x >= (*blocker).size() || tile.y >=(*blocker)[tile.x].size()) {
+    if(!collision_grid->unblock(tile.x, tile.y)) {
         VLOG(2) << "Block level can't be decresed at " << tile.x << " " << tile.y
-                << " as it is off the edge of the map";
+                << " as it is off the edge of the map or not blocked";
     } else {
-        (*blocker)[tile.x][tile.y]--;
         VLOG(2) << "Block level at tile " << tile.x << " " <<tile.y
-                << " decreased from " << (*blocker)[tile.x][tile.y] + 1
-                << " to " << (*blocker)[tile.x][tile.y] << ".";
+                << " decreased to " << collision_grid->get_block_count(tile.x, tile.y) << ".";
     }
 }
 
 Map::Blocker Map::block_tile(glm::ivec2 tile) {
-    return Blocker(tile, &blocker);
+    return Blocker(tile, &collision_grid);
 }
 
 bool Map::recalculate_layer_mappings(int x_pos, int y_pos, int layer_num) {
@@ -642,6 +642,9 @@ void Map::update_tile(int x_pos, int y_pos, const std::string layer_name, const
 
     // Add this tile to the layer data structure
     layer->update_tile(x_pos, y_pos, tile_id, tileset);
+    if (layer->get_id() == special_layer_id) {
+        collision_grid.set_terrain(x_pos, y_pos, tile_id == 1);
+    }
 
     int tile_offset;
 
@@ -12,9 +12,11 @@
 
 #include "open_gl.hpp"
 
+#include "collision_grid.hpp"
 #include "dispatcher.hpp"
 #include "fml.hpp"
 #include "map_loader.hpp"
+#include "pathfinder.hpp"
 
 class Layer;
 class TextureAtlas;
@@ -185,11 +187,20 @@ class Map {
     ///
     bool init_shaders();
 
+    ///
+    /// Which tiles are solid, from the special layer and the blockers
+    ///
+    CollisionGrid collision_grid;
+
+    ///
+    /// Path finding over this map's tiles
+    ///
+    Pathfinder pathfinder;
+
 public:
     Dispatcher<int> event_sprite_add;
     PositionDispatcher<int> event_step_on;
     PositionDispatcher<int> event_step_off;
-    std::vector<std::vector<int>> blocker;
 
     Map(const std::string map_src);
     ~Map();
@@ -231,24 +242,35 @@ public:
     int get_height() { return map_height; }
 
     ///
-    /// Is this location walkable
+    /// Is this location walkable, ignoring objects. Off the map is walkable.
     ///
     bool is_walkable(int x_pos, int y_pos);
 
     int get_tile_type(int x, int y);
 
     ///
-    /// This class is used for collision detection in the game. The map has a 2D-array of integers to determine if a position is solid or not. (called blocker)
-    /// When this class is instantiated, it increments the given position in the array.
+    /// Get the tiles which are solid, either from the special layer
+    /// or from blockers
+    ///
+    const CollisionGrid &get_collision_grid() { return collision_grid; }
+
+    ///
+    /// Get the path finder for this map
+    ///
+    Pathfinder &get_pathfinder() { return pathfinder; }
+
+    ///
+    /// This class is used for collision detection in the game. The map has a grid which counts how many blockers are on each position. (see CollisionGrid)
+    /// When this class is instantiated, it increments the given position in the grid.
     /// When it is destructed it decrements that same position.
     /// Positions off the edge of the map cannot be blocked, so those are ignored.
     class Blocker {
         public:
-            Blocker(glm::ivec2 tile, std::vector <std::vector<int>>* blocker);
+            Blocker(glm::ivec2 tile, CollisionGrid* collision_grid);
             ~Blocker();
             Blocker(const Map::Blocker &other);
             glm::ivec2 tile;
-            std::vector <std::vector<int>>* blocker;
+            CollisionGrid* collision_grid;
     };
 
     Blocker block_tile(glm::ivec2 tile);
@@ -135,6 +135,9 @@ void MapObject::set_game_position(glm::ivec2 position) {
 }
 
 void MapObject::set_render_position(glm::vec2 position) {
+    if (this->render_position != position) {
+        MapViewer::invalidate();
+    }
     this->render_position = position;
     VLOG(2) << std::fixed << position.x << " " << position.y;
 }
@@ -2,6 +2,7 @@
 #define GLM_FORCE_RADIANS
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <glog/logging.h>
 #include <glm/glm.hpp>
@@ -24,11 +25,14 @@
 #include "map_object.hpp"
 #include "map_viewer.hpp"
 #include "object_manager.hpp"
+#include "profiler.hpp"
 #include "renderable_component.hpp"
 #include "shader.hpp"
 
 #include "open_gl.hpp"
 
+std::atomic<bool> MapViewer::scene_changed(true);
+
 
 MapViewer::MapViewer(GameWindow *window, GUIManager *gui_manager):
     gui_manager(CHECK_NOTNULL(gui_manager)),
@@ -59,6 +63,7 @@ MapViewer::~MapViewer() {
 
 void MapViewer::resize() {
     LOG(INFO) << "Map resizing";
+    invalidate();
     std::pair<int, int> size(window->get_window_size());
 
     // Set the viewable fragments
@@ -74,6 +79,10 @@ void MapViewer::resize() {
 void MapViewer::render() {
     CHECK_NOTNULL(map);
 
+    // Cleared before drawing, so a change made while this frame is
+    // drawn still gets the next frame drawn, rather than being lost.
+    scene_changed.exchange(false);
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     render_map();
     render_objects();
@@ -81,6 +90,8 @@ void MapViewer::render() {
 }
 
 void MapViewer::render_map() {
+    Profiler::Timer timer(Profiler::MAP_RENDER);
+
     // Focus onto the player
     refocus_map();
     // Calculate the projection and modelview matrix for the map
@@ -142,6 +153,8 @@ void MapViewer::render_map() {
 }
 
 void MapViewer::render_objects() {
+    Profiler::Timer timer(Profiler::OBJECT_RENDER);
+
     //Calculate the projection matrix
     std::pair<int, int> size = window->get_resolution();
     glm::mat4 projection_matrix = glm::ortho(0.0f, float(size.first), 0.0f, float(size.second), 0.0f, 1.0f);
@@ -203,6 +216,8 @@ void MapViewer::render_objects() {
 }
 
 void MapViewer::render_gui() {
+    Profiler::Timer timer(Profiler::GUI_RENDER);
+
     //Calculate the projection matrix
     std::pair<int, int> size = window->get_resolution();
     glm::mat4 projection_matrix = glm::ortho(0.0f, float(size.first), 0.0f, float(size.second), 0.0f, 1.0f);
@@ -363,6 +378,7 @@ void MapViewer::set_map(Map* new_map) {
 }
 
 void MapViewer::set_map_focus_object(int object_id) {
+    invalidate();
     //Set the focus to the object if this is a valid object and it is on the map
     if(ObjectManager::is_valid_object_id(object_id)) {
         //        const std::vector<int>& objects = map->get_objects();
@@ -1,6 +1,7 @@
 #ifndef MAPVIEWER_H
 #define MAPVIEWER_H
 
+#include <atomic>
 #include <glm/vec2.hpp>
 
 class GameWindow;
@@ -39,6 +40,13 @@ class MapViewer {
     ///
     float map_display_y = 0.0f;
 
+    ///
+    /// Whether anything which is drawn has changed since the last render
+    /// started. Script threads invalidate too, such as when an entity's
+    /// animation frame changes, so it is atomic.
+    ///
+    static std::atomic<bool> scene_changed;
+
     ///
     /// Render the GUI
     ///
@@ -86,6 +94,20 @@ public:
     ///
     void render();
 
+    ///
+    /// Mark the scene as changed, so the next frame is rendered.
+    ///
+    /// Called whenever something which is drawn changes: render data,
+    /// object positions, tiles, the GUI, the camera or the window.
+    ///
+    static void invalidate() { scene_changed = true; }
+
+    ///
+    /// Whether the scene has changed since the last render
+    /// @return true if the last rendered frame is out of date
+    ///
+    static bool is_invalidated() { return scene_changed; }
+
     ///
     /// Set the map that the viewer is managing
     /// @param new_map The new map to manage
@@ -131,7 +153,7 @@ public:
     /// Set the x display position of the map
     /// @param new_display_x the new display position
     ///
-    void set_display_x(float new_display_x) { map_display_x = new_display_x; }
+    void set_display_x(float new_display_x) { if (map_display_x != new_display_x) { map_display_x = new_display_x; invalidate(); } }
 
     ///
     /// Get the map display bottom y position
@@ -142,7 +164,7 @@ public:
     /// Set the y display position of the map
     /// @param new_display_y the new display position
     ///
-    void set_display_y(float new_display_y) { map_display_y = new_display_y; }
+    void set_display_y(float new_display_y) { if (map_display_y != new_display_y) { map_display_y = new_display_y; invalidate(); } }
 
     ///
     /// converts pixel location inside window to a map tile
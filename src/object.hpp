@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 
+#include "map_viewer.hpp"
 #include "renderable_component.hpp"
 
 
@@ -79,7 +80,12 @@ public:
     /// Set whether the object can be rendered
     /// @param can_render true if the object can be rendered and false if not
     ///
-    void set_renderable(bool can_render) { renderable = can_render; }
+    void set_renderable(bool can_render) {
+        if (renderable != can_render) {
+            MapViewer::invalidate();
+        }
+        renderable = can_render;
+    }
 
     ///
     /// The Python thread for running scripts in.
@@ -93,6 +93,13 @@ public:
     template <typename R>
     std::shared_ptr<R> get_object(int object_id);
 
+    ///
+    /// Call a function with every object of the given type, in order of id
+    /// @param function called with a std::shared_ptr<R> for each object
+    ///
+    template <typename R, typename F>
+    void for_each_object(F function);
+
     ///
     /// Prints debug information
     ///
@@ -115,5 +122,15 @@ std::shared_ptr<R> ObjectManager::get_object(int object_id) {
     return std::dynamic_pointer_cast<R>(objects[object_id]);
 }
 
+template <typename R, typename F>
+void ObjectManager::for_each_object(F function) {
+    for (auto &object_pair : objects) {
+        // Skip objects which are not of the required type
+        if (auto object = std::dynamic_pointer_cast<R>(object_pair.second)) {
+            function(object);
+        }
+    }
+}
+
 
 #endif
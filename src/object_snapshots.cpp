@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <atomic>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "map_object.hpp"
+#include "object_manager.hpp"
+#include "object_snapshots.hpp"
+#include "walkability.hpp"
+
+ObjectSnapshots::ObjectSnapshots():
+    front(-1) {
+}
+
+ObjectSnapshots &ObjectSnapshots::get_instance() {
+    static ObjectSnapshots global_instance;
+    return global_instance;
+}
+
+void ObjectSnapshots::publish() {
+    int back(front == 0 ? 1 : 0);
+
+    // A reader may still have the back snapshot from before the last
+    // publish. Readers only hold it for one lookup, so wait for them
+    // rather than leave scripts reading an old state.
+    while (snapshots[back].readers != 0) {
+        std::this_thread::yield();
+    }
+
+    // Reuses the vector's storage, so this doesn't allocate once the
+    // number of objects settles.
+    auto &states(snapshots[back].states);
+    states.clear();
+    ObjectManager::get_instance().for_each_object<MapObject>([&states] (std::shared_ptr<MapObject> object) {
+        ObjectState state;
+        state.position = object->get_game_position();
+        state.moving = object->is_moving();
+        state.solid = object->get_walkability() == Walkability::BLOCKED;
+        states.push_back(std::make_pair(object->get_id(), state));
+    });
+
+    front = back;
+}
+
+bool ObjectSnapshots::get_state(int id, ObjectState &state) {
+    // Count this thread onto the front snapshot. If it was swapped before
+    // the count went up, the main thread may be writing to it, so retry.
+    int index;
+    while (true) {
+        index = front;
+        if (index == -1) {
+            return false;
+        }
+
+        ++snapshots[index].readers;
+        if (front == index) {
+            break;
+        }
+        --snapshots[index].readers;
+    }
+
+    const auto &states(snapshots[index].states);
+    auto found(std::lower_bound(std::begin(states), std::end(states), id,
+        [] (const std::pair<int, ObjectState> &entry, int id) { return entry.first < id; }
+    ));
+
+    bool has_state(found != std::end(states) && found->first == id);
+    if (has_state) {
+        state = found->second;
+    }
+
+    --snapshots[index].readers;
+    return has_state;
+}
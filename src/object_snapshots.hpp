@@ -0,0 +1,86 @@
+#ifndef OBJECT_SNAPSHOTS_H
+#define OBJECT_SNAPSHOTS_H
+
+#include <atomic>
+#include <glm/vec2.hpp>
+#include <utility>
+#include <vector>
+
+///
+/// The state of a MapObject which scripts can read, as of the last publish.
+///
+struct ObjectState {
+    glm::ivec2 position;
+    bool moving;
+    bool solid;
+};
+
+///
+/// A double-buffered copy of every MapObject's state, published by the
+/// main loop after every pass over the events and once a frame.
+///
+/// The Python threads read objects from here rather than through the
+/// ObjectManager, which the main thread changes as it moves objects.
+/// Reads don't lock and are consistent between publishes, so scripts can
+/// poll (such as `while player.is_moving(): pass`) cheaply.
+///
+/// Readers count themselves onto the front buffer. The main thread only
+/// ever writes the back buffer, and waits for its last reader to leave
+/// first.
+///
+class ObjectSnapshots {
+private:
+    struct Snapshot {
+        ///
+        /// Object states by id, sorted by id.
+        ///
+        std::vector<std::pair<int, ObjectState>> states;
+
+        ///
+        /// How many threads are reading this snapshot.
+        ///
+        std::atomic<int> readers;
+
+        Snapshot(): readers(0) {}
+    };
+
+    Snapshot snapshots[2];
+
+    ///
+    /// The index of the snapshot to read, or -1 before the first publish.
+    ///
+    std::atomic<int> front;
+
+    ObjectSnapshots();
+
+public:
+    static ObjectSnapshots &get_instance();
+
+    ObjectSnapshots(ObjectSnapshots const&) = delete;
+    void operator=(ObjectSnapshots const&) = delete;
+
+    ///
+    /// Copy the state of every MapObject into the back snapshot and make
+    /// it the front one.
+    ///
+    /// Only for use from the main thread.
+    ///
+    void publish();
+
+    ///
+    /// Get an object's state as of the last publish.
+    ///
+    /// Thread safe.
+    ///
+    /// @param id
+    ///     The id of the MapObject.
+    ///
+    /// @param state
+    ///     Set to the object's state, if it was published.
+    ///
+    /// @return whether the object was in the last snapshot
+    ///
+    bool get_state(int id, ObjectState &state);
+};
+
+#endif
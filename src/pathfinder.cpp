@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <mutex>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "collision_grid.hpp"
+#include "pathfinder.hpp"
+
+///
+/// The four steps an object can take, in the order they are tried.
+///
+static const glm::ivec2 neighbour_steps[] = {
+    glm::ivec2( 0,  1),
+    glm::ivec2( 1,  0),
+    glm::ivec2( 0, -1),
+    glm::ivec2(-1,  0)
+};
+
+Pathfinder::Pathfinder(const CollisionGrid *collision_grid):
+    collision_grid(collision_grid),
+    cached_version(0) {
+}
+
+bool Pathfinder::in_map(glm::ivec2 tile) {
+    return collision_grid->in_bounds(tile.x, tile.y);
+}
+
+bool Pathfinder::is_passable(glm::ivec2 tile) {
+    return !collision_grid->is_solid(tile.x, tile.y);
+}
+
+int Pathfinder::to_index(glm::ivec2 tile) {
+    return tile.x + tile.y * collision_grid->get_width();
+}
+
+int Pathfinder::get_tile_count() {
+    return collision_grid->get_width() * collision_grid->get_height();
+}
+
+void Pathfinder::refresh() {
+    if (cached_version == collision_grid->get_version()) {
+        return;
+    }
+
+    cached_version = collision_grid->get_version();
+    paths.clear();
+    flow_fields.clear();
+}
+
+std::vector<glm::ivec2> Pathfinder::find_path(glm::ivec2 start, glm::ivec2 goal) {
+    std::lock_guard<std::mutex> lock(pathfinder_lock);
+    std::lock_guard<std::mutex> grid_lock(collision_grid->get_lock());
+    refresh();
+
+    if (start == goal || !in_map(start) || !in_map(goal)) {
+        return std::vector<glm::ivec2>();
+    }
+
+    int start_index(to_index(start));
+    int goal_index(to_index(goal));
+
+    auto cached(paths.find(std::make_pair(start_index, goal_index)));
+    if (cached != std::end(paths)) {
+        return cached->second;
+    }
+
+    int width(collision_grid->get_width());
+    auto to_tile([width] (int index) { return glm::ivec2(index % width, index / width); });
+    auto estimate([goal] (glm::ivec2 tile) { return std::abs(goal.x - tile.x) + std::abs(goal.y - tile.y); });
+
+    std::vector<int> cost(get_tile_count(), -1);
+    std::vector<int> came_from(get_tile_count(), -1);
+
+    // Tiles to expand as (estimated total cost, index), cheapest first.
+    // A tile is pushed again whenever a cheaper way to it is found, and
+    // the outdated entries are skipped when they come up.
+    typedef std::pair<int, int> OpenTile;
+    std::priority_queue<OpenTile, std::vector<OpenTile>, std::greater<OpenTile>> open;
+
+    cost[start_index] = 0;
+    open.push(OpenTile(estimate(start), start_index));
+
+    while (!open.empty()) {
+        OpenTile current(open.top());
+        open.pop();
+
+        int index(current.second);
+        glm::ivec2 tile(to_tile(index));
+        if (current.first != cost[index] + estimate(tile)) {
+            continue;
+        }
+        if (index == goal_index) {
+            break;
+        }
+
+        for (auto step : neighbour_steps) {
+            glm::ivec2 next(tile + step);
+            if (!in_map(next)) {
+                continue;
+            }
+
+            int next_index(to_index(next));
+            if (!is_passable(next) && next_index != goal_index) {
+                continue;
+            }
+
+            int next_cost(cost[index] + 1);
+            if (cost[next_index] == -1 || next_cost < cost[next_index]) {
+                cost[next_index] = next_cost;
+                came_from[next_index] = index;
+                open.push(OpenTile(next_cost + estimate(next), next_index));
+            }
+        }
+    }
+
+    std::vector<glm::ivec2> path;
+    if (cost[goal_index] != -1) {
+        for (int index = goal_index; index != start_index; index = came_from[index]) {
+            path.push_back(to_tile(index) - to_tile(came_from[index]));
+        }
+        std::reverse(std::begin(path), std::end(path));
+    }
+
+    if (paths.size() >= max_cached_paths) {
+        paths.clear();
+    }
+    paths[std::make_pair(start_index, goal_index)] = path;
+
+    return path;
+}
+
+glm::ivec2 Pathfinder::get_flow_direction(glm::ivec2 from, std::vector<glm::ivec2> targets) {
+    std::lock_guard<std::mutex> lock(pathfinder_lock);
+    std::lock_guard<std::mutex> grid_lock(collision_grid->get_lock());
+    refresh();
+
+    std::vector<int> target_indices;
+    for (auto target : targets) {
+        if (in_map(target)) {
+            target_indices.push_back(to_index(target));
+        }
+    }
+    std::sort(std::begin(target_indices), std::end(target_indices));
+    target_indices.erase(std::unique(std::begin(target_indices), std::end(target_indices)),
+                         std::end(target_indices));
+
+    if (!in_map(from) || target_indices.empty()) {
+        return glm::ivec2(0, 0);
+    }
+
+    auto field(flow_fields.find(target_indices));
+    if (field == std::end(flow_fields)) {
+        // Breadth-first search outwards from every target at once. The
+        // targets themselves may be blocked, but only walkable tiles are
+        // searched through.
+        std::vector<int> distance(get_tile_count(), -1);
+        std::queue<int> frontier;
+        for (int index : target_indices) {
+            distance[index] = 0;
+            frontier.push(index);
+        }
+
+        int width(collision_grid->get_width());
+        while (!frontier.empty()) {
+            int index(frontier.front());
+            frontier.pop();
+
+            glm::ivec2 tile(index % width, index / width);
+            for (auto step : neighbour_steps) {
+                glm::ivec2 next(tile + step);
+                if (!in_map(next)) {
+                    continue;
+                }
+
+                int next_index(to_index(next));
+                if (is_passable(next) && distance[next_index] == -1) {
+                    distance[next_index] = distance[index] + 1;
+                    frontier.push(next_index);
+                }
+            }
+        }
+
+        if (flow_fields.size() >= max_cached_flow_fields) {
+            flow_fields.clear();
+        }
+        field = flow_fields.insert(std::make_pair(target_indices, distance)).first;
+    }
+
+    const std::vector<int> &distance(field->second);
+    if (distance[to_index(from)] == 0) {
+        return glm::ivec2(0, 0);
+    }
+
+    // The tile being stepped from is usually blocked by whatever is
+    // asking, so it may have no distance of its own; just take the
+    // closest neighbour.
+    glm::ivec2 best_step(0, 0);
+    int best_distance(-1);
+    for (auto step : neighbour_steps) {
+        glm::ivec2 next(from + step);
+        if (!in_map(next)) {
+            continue;
+        }
+
+        int next_distance(distance[to_index(next)]);
+        if (next_distance != -1 && (best_distance == -1 || next_distance < best_distance)) {
+            best_step = step;
+            best_distance = next_distance;
+        }
+    }
+
+    return best_step;
+}
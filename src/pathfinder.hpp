@@ -0,0 +1,101 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/vec2.hpp>
+
+class CollisionGrid;
+
+///
+/// Path finding on a map's tile grid, so scripts don't have to build
+/// their own graph out of one is_solid call per tile.
+///
+/// Movement is 4-connected and a tile can be walked on if it is in the
+/// map and not solid in the map's collision grid, which is searched in
+/// place.
+///
+/// Paths and flow fields are cached and reused until the grid's version
+/// changes. Queries lock the caches and hold the grid's lock while they
+/// search it, so they can be made from script threads.
+///
+class Pathfinder {
+public:
+    Pathfinder(const CollisionGrid *collision_grid);
+
+    ///
+    /// Find a shortest path between two tiles using A*.
+    ///
+    /// The start tile may be blocked, as it usually is by the object
+    /// which will walk the path, and so may the goal, so that a path
+    /// can lead up to another object.
+    ///
+    /// @param start The tile to start from.
+    /// @param goal The tile to reach.
+    /// @return
+    ///     The relative steps, each one tile long, which lead from start
+    ///     to goal. Empty if start is goal or the goal can't be reached.
+    ///
+    std::vector<glm::ivec2> find_path(glm::ivec2 start, glm::ivec2 goal);
+
+    ///
+    /// Find which way to step towards the nearest of some targets,
+    /// using a flow field from the targets.
+    ///
+    /// The field is shared by every query with the same targets, so many
+    /// objects heading for the same place cost a single search.
+    ///
+    /// @param from The tile to step from.
+    /// @param targets The tiles to head for. Tiles off the map are ignored.
+    /// @return
+    ///     A step one tile long, or (0, 0) if from is a target or none of
+    ///     them can be reached.
+    ///
+    glm::ivec2 get_flow_direction(glm::ivec2 from, std::vector<glm::ivec2> targets);
+
+private:
+    const CollisionGrid *collision_grid;
+
+    std::mutex pathfinder_lock;
+
+    ///
+    /// The version of the grid that the caches were made for.
+    ///
+    unsigned int cached_version;
+
+    ///
+    /// Found paths, by start and goal tile index.
+    ///
+    std::map<std::pair<int, int>, std::vector<glm::ivec2>> paths;
+
+    ///
+    /// Flow fields by sorted target tile indices. Each holds the number
+    /// of steps from every tile to the nearest target, or -1 if there is
+    /// no way there.
+    ///
+    std::map<std::vector<int>, std::vector<int>> flow_fields;
+
+    ///
+    /// Caches are cleared rather than grown past these sizes.
+    ///
+    static const std::size_t max_cached_paths = 256;
+    static const std::size_t max_cached_flow_fields = 16;
+
+    ///
+    /// Drop the caches if the grid has changed.
+    /// pathfinder_lock must be held.
+    ///
+    void refresh();
+
+    bool in_map(glm::ivec2 tile);
+    bool is_passable(glm::ivec2 tile);
+    int to_index(glm::ivec2 tile);
+    int get_tile_count();
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <boost/python/list.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/filesystem.hpp>
+#include <deque>
 #include <glm/vec2.hpp>
 #include <glog/logging.h>
 #include <ostream>
@@ -20,6 +21,7 @@
 #include "event_manager.hpp"
 #include "game_time.hpp"
 #include "object_manager.hpp"
+#include "object_snapshots.hpp"
 #include "map_object.hpp"
 #include "map_viewer.hpp"
 
@@ -79,7 +81,27 @@ void Entity::move_south(PyObject *callback) {
     return (move_by(0, -1, 0.3, callback));
 }
 
+void Entity::move_path(boost::python::list path, PyObject *callback) {
+    ++call_number;
+    boost::python::object boost_callback(boost::python::handle<>(boost::python::borrowed(callback)));
+
+    std::deque<glm::ivec2> steps;
+    for (int i = 0; i < len(path); ++i) {
+        int x = boost::python::extract<int>(path[i][0]);
+        int y = boost::python::extract<int>(path[i][1]);
+        steps.push_back(glm::ivec2(x, y));
+    }
+
+    Engine::move_path(id, steps, 0.3, boost_callback);
+}
+
 bool Entity::is_moving() {
+    ObjectState state;
+    if (ObjectSnapshots::get_instance().get_state(this->id, state)) {
+        return state.moving;
+    }
+
+    // Not published yet, as the first frame hasn't finished
     auto object = ObjectManager::get_instance().get_object<MapObject>(this->id);
     return object->is_moving();
 }
@@ -119,6 +141,11 @@ bool Entity::is_visible() {
 }
 
 bool Entity::is_solid() {
+    ObjectState state;
+    if (ObjectSnapshots::get_instance().get_state(this->id, state)) {
+        return state.solid;
+    }
+
     auto object = ObjectManager::get_instance().get_object<MapObject>(this->id);
     Walkability w = object->get_walkability();
     if (w == Walkability::BLOCKED) {
@@ -312,6 +339,11 @@ int Entity::get_id() {
 }
 
 py::tuple Entity::get_position() {
+    ObjectState state;
+    if (ObjectSnapshots::get_instance().get_state(this->id, state)) {
+        return py::make_tuple(state.position.x, state.position.y);
+    }
+
     auto object = ObjectManager::get_instance().get_object<MapObject>(this->id);
     glm::ivec2 position = object->get_game_position();
     return py::make_tuple(position.x, position.y);
@@ -98,6 +98,18 @@ class Entity {
         void move_north(PyObject *callback);
         void move_west(PyObject *callback);
 
+        ///
+        /// Move entity along a path of relative steps, such as
+        /// [(1, 0), (0, 1)], in one call.
+        ///
+        /// @param path
+        ///     List of (x, y) steps, in tiles.
+        ///
+        /// @param callback
+        ///     Called once, when the path is finished or a step is blocked.
+        ///
+        void move_path(boost::python::list path, PyObject *callback);
+
 
         ///
         /// @return
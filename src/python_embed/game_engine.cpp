@@ -1,17 +1,29 @@
 #include <glog/logging.h>
 #include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "audio_engine.hpp"
 #include "button.hpp"
 #include "challenge.hpp"
 #include "challenge_data.hpp"
 #include "config.hpp"
+#include "dialogue_table.hpp"
 #include "engine.hpp"
 #include "event_manager.hpp"
 #include "game_engine.hpp"
 #include "gui_main.hpp"
+#include "locks.hpp"
 #include "map_loader.hpp"
 #include "map.hpp"
+#include "map_viewer.hpp"
+#include "pathfinder.hpp"
+#include "profiler.hpp"
+#include "save_store.hpp"
+#include "script_budget.hpp"
+#include "script_checker.hpp"
 #include "text_font.hpp"
 
 GameEngine::GameEngine(GUIMain *_gui_main, Challenge *_challenge){
@@ -65,6 +77,15 @@ void GameEngine::show_dialogue(std::string text, bool ignore_scripting, PyObject
     Engine::open_notification_bar(ignore_scripting, boost_callback);
 }
 
+void GameEngine::prerender_dialogue(boost::python::list texts) {
+    std::deque<std::string> cpp_texts;
+    for(int i=0; i<len(texts); i++){
+        std::string text = boost::python::extract<std::string>(texts[i]);
+        cpp_texts.push_back(text);
+    }
+    Engine::prerender_dialogue(cpp_texts);
+}
+
 void GameEngine::show_external_script_help(std::string text, PyObject *callback) {
 
     if(Engine::is_bar_open()){
@@ -312,6 +333,112 @@ std::string GameEngine::get_external_script()
     return Engine::get_external_script();
 }
 
+boost::python::object GameEngine::get_compiled_script(std::string script)
+{
+    ScriptChecker *script_checker = Engine::get_script_checker();
+    if (!script_checker) {
+        return boost::python::object();
+    }
+    return script_checker->get_code(script);
+}
+
+std::string GameEngine::get_save_data(std::string section, std::string key) {
+    return SaveStore::get_instance().get(section, key);
+}
+
+bool GameEngine::has_save_data(std::string section, std::string key) {
+    return SaveStore::get_instance().has(section, key);
+}
+
+void GameEngine::set_save_data(std::string section, std::string key, std::string value) {
+    SaveStore::get_instance().set(section, key, value);
+}
+
+// Releases the GIL while waiting, as the writer may be a while.
+void GameEngine::flush_save() {
+    lock::ThreadGILRelease unlock_thread;
+    SaveStore::get_instance().flush();
+}
+
+void GameEngine::load_dialogue(std::string language, boost::python::list lines) {
+    std::vector<DialogueTable::Line> loaded;
+    for (int i = 0; i < boost::python::len(lines); ++i) {
+        boost::python::object line(lines[i]);
+        if (line[2].is_none()) {
+            continue;
+        }
+
+        DialogueTable::Line dialogue;
+        dialogue.level = boost::python::extract<std::string>(line[0]);
+        dialogue.identifier = boost::python::extract<std::string>(line[1]);
+        dialogue.text = boost::python::extract<std::string>(line[2]);
+        loaded.push_back(dialogue);
+    }
+
+    DialogueTable::get_instance().load(language, loaded);
+}
+
+std::string GameEngine::get_dialogue_language() {
+    return DialogueTable::get_instance().get_language();
+}
+
+std::string GameEngine::get_dialogue(std::string level, std::string identifier, boost::python::dict escapes) {
+    std::map<std::string, std::string> escape_values;
+    boost::python::list items(escapes.items());
+    for (int i = 0; i < boost::python::len(items); ++i) {
+        std::string name = boost::python::extract<std::string>(items[i][0]);
+        std::string value = boost::python::extract<std::string>(boost::python::str(items[i][1]));
+        escape_values[name] = value;
+    }
+
+    return DialogueTable::get_instance().get(level, identifier, escape_values);
+}
+
+void GameEngine::limit_script_thread(PyObject *halt_exception, PyObject *timeout_exception) {
+    Config::json j = Config::get_instance();
+    double cpu_budget = j["scripting"]["cpu_budget"];
+    int yield_interval = j["scripting"]["yield_interval"];
+
+    ScriptBudget::install(std::make_shared<ScriptBudget>(halt_exception, timeout_exception, cpu_budget, yield_interval));
+}
+
+void GameEngine::limit_level_thread(PyObject *halt_exception) {
+    Config::json j = Config::get_instance();
+    int yield_interval = j["scripting"]["yield_interval"];
+
+    ScriptBudget::install(std::make_shared<ScriptBudget>(halt_exception, halt_exception, 0.0, yield_interval));
+}
+
+void GameEngine::limit_coroutine_step(PyObject *timeout_exception) {
+    Config::json j = Config::get_instance();
+    double step_budget = j["scripting"]["coroutine_step_budget"];
+    int yield_interval = j["scripting"]["yield_interval"];
+
+    ScriptBudget::install(std::make_shared<ScriptBudget>(timeout_exception, timeout_exception, step_budget, yield_interval));
+}
+
+void GameEngine::unlimit_coroutine_step() {
+    ScriptBudget::uninstall();
+}
+
+bool GameEngine::halt_script_thread(long thread_id) {
+    return ScriptBudget::halt_thread(thread_id);
+}
+
+// The profiler is only touched from the main thread, so the export waits
+// for the event loop.
+void GameEngine::export_profile_csv(std::string filename) {
+    EventManager::get_instance()->add_event([filename] () {
+        Profiler::get_instance()->export_csv(filename);
+    });
+}
+
+void GameEngine::export_profile_trace(std::string filename) {
+    EventManager::get_instance()->add_event([filename] () {
+        Profiler::get_instance()->export_chrome_trace(filename);
+    });
+}
+
 void GameEngine::print_terminal(std::string text, bool error) {
     Engine::print_terminal(text, error);
 }
@@ -360,6 +487,30 @@ bool GameEngine::is_solid(int x, int y) {
     return !Engine::walkable(glm::ivec2(x, y)); //TODO: Make syntax of Engine match this!
 }
 
+boost::python::list GameEngine::find_path(int start_x, int start_y, int goal_x, int goal_y) {
+    Pathfinder &pathfinder(Engine::get_map_viewer()->get_map()->get_pathfinder());
+    std::vector<glm::ivec2> path(pathfinder.find_path(glm::ivec2(start_x, start_y), glm::ivec2(goal_x, goal_y)));
+
+    boost::python::list python_list;
+    for (auto step : path) {
+        python_list.append(boost::python::make_tuple(step.x, step.y));
+    }
+    return python_list;
+}
+
+boost::python::tuple GameEngine::get_flow_direction(int x, int y, boost::python::list targets) {
+    std::vector<glm::ivec2> target_tiles;
+    for (int i = 0; i < len(targets); ++i) {
+        int target_x = boost::python::extract<int>(targets[i][0]);
+        int target_y = boost::python::extract<int>(targets[i][1]);
+        target_tiles.push_back(glm::ivec2(target_x, target_y));
+    }
+
+    Pathfinder &pathfinder(Engine::get_map_viewer()->get_map()->get_pathfinder());
+    glm::ivec2 step(pathfinder.get_flow_direction(glm::ivec2(x, y), target_tiles));
+    return boost::python::make_tuple(step.x, step.y);
+}
+
 void GameEngine::refresh_config() {
     Config::refresh_config();
 }
@@ -1,6 +1,7 @@
 #ifndef GAME_ENGINE_H
 #define GAME_ENGINE_H
 
+#include <boost/python/dict.hpp>
 #include <boost/python/object_core.hpp>
 #include <boost/python/list.hpp>
 #include <string>
@@ -100,6 +101,12 @@ class GameEngine {
         void show_external_script_help(std::string text, PyObject *callback);
         void close_external_script_help(PyObject *callback);
 
+        ///
+        /// Render the pages of a list of dialogues ahead of time,
+        /// so that they are ready when they are shown
+        ///
+        void prerender_dialogue(boost::python::list texts);
+
         ///
         /// Register a callback against a given input
         ///
@@ -167,6 +174,144 @@ class GameEngine {
         ///
         std::string get_external_script();
 
+        ///
+        /// Get the code object for a script which the PyScripter has
+        /// already compiled in the background, so it doesn't have to be
+        /// parsed again before running.
+        ///
+        /// @return the code object, or None if the script hasn't been compiled
+        ///
+        boost::python::object get_compiled_script(std::string script);
+
+        ///
+        /// Limit the calling thread, which runs a player's script, to the
+        /// CPU time budget in the config. The thread also regularly lets
+        /// the game take the GIL, and can be halted with halt_script_thread.
+        ///
+        /// @param halt_exception
+        ///     The exception type raised in the script once it's halted.
+        ///
+        /// @param timeout_exception
+        ///     The exception type raised in the script once it has used
+        ///     its budget.
+        ///
+        void limit_script_thread(PyObject *halt_exception, PyObject *timeout_exception);
+
+        ///
+        /// Limit the calling thread, which runs the level script, so that
+        /// it regularly lets the game take the GIL and can be halted with
+        /// PythonThreadRunner::halt_hard. Level scripts run for as long as
+        /// the level does, so their CPU time isn't limited.
+        ///
+        /// Only the code the calling function goes on to run is halted,
+        /// so the caller can clean up once the exception gets back to it.
+        ///
+        /// @param halt_exception
+        ///     The exception type raised in the level script once it's
+        ///     halted.
+        ///
+        void limit_level_thread(PyObject *halt_exception);
+
+        ///
+        /// Limit the calling thread while it runs one step of a level
+        /// script coroutine, until unlimit_coroutine_step is called.
+        /// Coroutines run on the game's thread, which is frozen until
+        /// they await, so a step may only use the CPU time in the config.
+        ///
+        /// Only the code the calling function goes on to run is stopped.
+        ///
+        /// @param timeout_exception
+        ///     The exception type raised in the coroutine once it has
+        ///     used its budget.
+        ///
+        void limit_coroutine_step(PyObject *timeout_exception);
+
+        ///
+        /// Stop limiting the calling thread after limit_coroutine_step.
+        ///
+        void unlimit_coroutine_step();
+
+        ///
+        /// Halt a thread limited by limit_script_thread. The script can't
+        /// catch the exception and carry on, unlike an asynchronous one.
+        ///
+        /// @param thread_id
+        ///     The thread's ID according to CPython.
+        ///
+        /// @return whether the thread was limited, and so will halt
+        ///
+        bool halt_script_thread(long thread_id);
+
+        ///
+        /// Get a value from the save game.
+        ///
+        /// @param section
+        ///     The top-level key, such as "settings".
+        ///
+        /// @param key
+        ///     The key within the section, or an empty string for the
+        ///     whole section.
+        ///
+        /// @return the value as JSON text, or "null" if there isn't one
+        ///
+        std::string get_save_data(std::string section, std::string key);
+
+        ///
+        /// @return whether the save game has a value for the key in the section
+        ///
+        bool has_save_data(std::string section, std::string key);
+
+        ///
+        /// Change a value in the save game. It is written to disk in the
+        /// background soon after.
+        ///
+        /// @param value
+        ///     JSON text.
+        ///
+        void set_save_data(std::string section, std::string key, std::string value);
+
+        ///
+        /// Wait until every change to the save game has been written to disk.
+        ///
+        void flush_save();
+
+        ///
+        /// Replace the dialogue table with the given lines.
+        ///
+        /// @param language
+        ///     The language the lines are in.
+        ///
+        /// @param lines
+        ///     (level, identifier, text) tuples. Lines without text are skipped.
+        ///
+        void load_dialogue(std::string language, boost::python::list lines);
+
+        ///
+        /// @return the language of the loaded dialogue table, or an empty
+        /// string if it hasn't been loaded
+        ///
+        std::string get_dialogue_language();
+
+        ///
+        /// Look up a line in the dialogue table, replacing each %escape%
+        /// given with its value.
+        ///
+        /// @return the line, or "invalid dialogue identifier" if there isn't one
+        ///
+        std::string get_dialogue(std::string level, std::string identifier, boost::python::dict escapes);
+
+        ///
+        /// Write the profiler's recent frame timings to a CSV file,
+        /// with a row per frame and a column per part of the game loop.
+        ///
+        void export_profile_csv(std::string filename);
+
+        ///
+        /// Write the profiler's recent timings to a Chrome trace JSON
+        /// file, which can be opened in chrome://tracing.
+        ///
+        void export_profile_trace(std::string filename);
+
         /// Print text to the QT terminal widget
         /// If error is True the text is red
         /// If error is False the text is black
@@ -201,6 +346,21 @@ class GameEngine {
 
         bool is_solid(int x, int y);
 
+        ///
+        /// Find a shortest path between two tiles, avoiding anything solid.
+        /// @return a list of (x, y) steps, one tile each, as taken by
+        /// move_path; empty if there is no way there
+        ///
+        boost::python::list find_path(int start_x, int start_y, int goal_x, int goal_y);
+
+        ///
+        /// Find which way to step from a tile to get closer to the nearest
+        /// of the given (x, y) targets, avoiding anything solid.
+        /// @return an (x, y) step, or (0, 0) if already at a target or
+        /// none can be reached
+        ///
+        boost::python::tuple get_flow_direction(int x, int y, boost::python::list targets);
+
         ///
         /// Force the config file to be loaded in again, useful for if you have changed any settings in it.
         ///
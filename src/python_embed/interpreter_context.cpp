@@ -2,7 +2,9 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/python.hpp>
+#include <ctime>
 #include <map>
+#include <string>
 #include "interpreter_context.hpp"
 
 namespace py = boost::python;
@@ -20,6 +22,22 @@ PyInterpreterState *InterpreterContext::get_interpreterstate() {
 
 
 py::api::object InterpreterContext::import_file(boost::filesystem::path filename) {
+    // Modules by path, as (modification time, module) tuples. This is
+    // never freed, as it must not be destroyed after the interpreter
+    // has been finalised. Only used with the GIL held.
+    static py::dict *imported_files(new py::dict());
+
+    std::string path = boost::filesystem::absolute(filename).string();
+    std::time_t modification_time = boost::filesystem::last_write_time(filename);
+
+    if (imported_files->has_key(path)) {
+        py::tuple imported((*imported_files)[path]);
+        std::time_t imported_time = py::extract<std::time_t>(imported[0]);
+        if (imported_time == modification_time) {
+            return imported[1];
+        }
+    }
+
     std::string name = filename.stem().string();
 
     py::list paths;
@@ -27,10 +45,13 @@ py::api::object InterpreterContext::import_file(boost::filesystem::path filename
 
     auto imp_module = py::import("imp");
     auto module_data = imp_module.attr("find_module")(name, paths);
-    return imp_module.attr("load_module")(
+    py::api::object module = imp_module.attr("load_module")(
         name,
         py::api::object(module_data[0]), // file
         py::api::object(module_data[1]), // pathname
         py::api::object(module_data[2])  // description
     );
+
+    (*imported_files)[path] = py::make_tuple(modification_time, module);
+    return module;
 }
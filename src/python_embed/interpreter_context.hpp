@@ -55,6 +55,12 @@ class InterpreterContext {
         ///
         ///         - If it is neither, an std::runtime_error is thrown.
         ///
+        /// The module is cached by path, and importing the same file
+        /// again returns the cached module without running it again,
+        /// unless the file has been modified since.
+        ///
+        /// The GIL must be held.
+        ///
         /// @return
         ///     A Python module object.
         ///
@@ -5,6 +5,7 @@
 #include <mutex>
 #include "interpreter_context.hpp"
 #include "locks.hpp"
+#include "profiler.hpp"
 
 
 namespace lock {
@@ -38,7 +39,10 @@ namespace lock {
         ++i;
 
         VLOG(1) << inst << " Aquiring GIL lock  " << name;
-        PyEval_RestoreThread(interpreter_context.get_threadstate());
+        {
+            Profiler::Timer timer(Profiler::GIL_WAIT);
+            PyEval_RestoreThread(interpreter_context.get_threadstate());
+        }
         VLOG(1) << inst << " GIL lock aquired   " << name;
     }
 
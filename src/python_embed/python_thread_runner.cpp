@@ -9,6 +9,7 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/python.hpp>
 #include <boost/ref.hpp>
+#include <chrono>
 #include <future>
 #include <glog/logging.h>
 #include <glm/vec2.hpp>
@@ -23,12 +24,15 @@
 #include "locks.hpp"
 #include "make_unique.hpp"
 #include "game_engine.hpp"
+#include "script_budget.hpp"
 
 // For PyThread_get_thread_ident
 #include "pythread.h"
 
 namespace py = boost::python;
 
+const int PythonThreadRunner::soft_halt_timeout_ms;
+
 LockablePythonThreadRunner::LockablePythonThreadRunner():
     lock::Lockable<std::shared_ptr<PythonThreadRunner>>() {}
 
@@ -61,6 +65,7 @@ LockablePythonThreadRunner::LockablePythonThreadRunner(std::shared_ptr<PythonThr
 ///     by access of the interpreter's PyInterpreterState.
 ///
 ///     Also allows importing files.
+///
 /// TODO: Create some kind python engine object and suitable api for engine stuff!!!!!
 void run_entities(std::atomic<bool> &on_finish,
                 std::shared_ptr<py::api::object> entities_object,
@@ -84,7 +89,7 @@ void run_entities(std::atomic<bool> &on_finish,
         lock::ThreadGIL lock_thread(threadstate);
 
         LOG(INFO) << "run_entity: Stolen GIL";
-        
+
         try {
             // Import the bootstrapper file, check it for errors
             bootstrapper_module = std::make_unique<py::api::object>(
@@ -181,6 +186,8 @@ PythonThreadRunner::PythonThreadRunner(InterpreterContext interpreter_context, s
     })
 
     {
+        Config::json j = Config::get_instance();
+
         // To get thread_id
         std::promise<long> thread_id_promise;
         thread_id_future = thread_id_promise.get_future();
@@ -201,7 +208,6 @@ PythonThreadRunner::PythonThreadRunner(InterpreterContext interpreter_context, s
         }
 
         py::api::object game_engine_object = py::api::object(boost::ref(game_engine));
-        Config::json j = Config::get_instance();
         std::string game_folder = j["files"]["game_folder"];
 
         thread = std::thread(
@@ -241,10 +247,8 @@ void PythonThreadRunner::halt_soft(Signal signal) {
 }
 
 void PythonThreadRunner::halt_hard() {
-    // TODO: everything!!!
-    throw std::runtime_error("hard halting not implemented");
-
-    lock::GIL lock_gil(interpreter_context, "PythonThreadRunner::halt_hard");
+    // The bootstrapper installs the budget while it runs the level script
+    ScriptBudget::halt_thread(get_thread_id());
 }
 
 bool PythonThreadRunner::is_dirty() {
@@ -256,11 +260,15 @@ void PythonThreadRunner::clean() {
 }
 
 void PythonThreadRunner::finish() {
-    // TODO: implement nagging
-    while (true) {
+    // The level script may catch the soft signal, so nag it until it
+    // finishes. If it keeps ignoring it, halt it hard, which the
+    // bootstrapper still gets to clean up after.
+    auto give_up_time(std::chrono::steady_clock::now() + std::chrono::milliseconds(soft_halt_timeout_ms));
+    while (!thread_finished) {
         halt_soft(Signal::KILL);
-
-        if (thread_finished) { break; }
+        if (std::chrono::steady_clock::now() >= give_up_time) {
+            halt_hard();
+        }
 
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
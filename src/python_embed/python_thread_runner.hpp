@@ -6,6 +6,7 @@
 #include <atomic>
 #include <future>
 #include <map>
+#include <memory>
 #include <thread>
 #include <list>
 #include "dispatcher.hpp"
@@ -126,6 +127,12 @@ class PythonThreadRunner {
         ///
         std::shared_ptr<boost::python::list> entity_object;
 
+        ///
+        /// How long finish waits for the level script to handle the
+        /// soft KILL signal before halting it hard.
+        ///
+        static const int soft_halt_timeout_ms = 1000;
+
         ///
         /// Finish and join the spawned thread.
         ///
@@ -201,11 +208,16 @@ class PythonThreadRunner {
         ///
         /// Try to kill the thread without mortal concerns for such things as life and death.
         ///
-        /// @warning
-        ///     This needs to be, but is not, totally thread safe.
+        /// Every line of the level script the thread runs from now on
+        /// raises the KILL exception, so unlike with halt_soft, the level
+        /// script can't catch it and carry on. Does nothing if the level
+        /// script isn't running (see GameEngine::limit_level_thread).
+        ///
+        /// Termination is still not guaranteed, as the thread may be
+        /// stuck outside of Python code.
         ///
-        /// Neither termination nor safety is guaranteed, although
-        /// termination is more likely than with halt_soft.
+        /// @warning
+        ///     Not thread safe, as it uses get_thread_id.
         ///
         void halt_hard();
 
@@ -0,0 +1,164 @@
+#include "python_embed_headers.hpp"
+
+#include <atomic>
+#include <boost/python.hpp>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "script_budget.hpp"
+
+// For PyFrameObject's fields and PyThread_get_thread_ident
+#include "frameobject.h"
+#include "pythread.h"
+
+std::map<long, std::weak_ptr<ScriptBudget>> ScriptBudget::budgets;
+std::mutex ScriptBudget::budgets_lock;
+
+ScriptBudget::ScriptBudget(PyObject *halt_exception, PyObject *timeout_exception, double cpu_budget, int yield_interval):
+    halt_exception(halt_exception),
+    timeout_exception(timeout_exception),
+    cpu_budget(cpu_budget),
+    yield_interval(yield_interval),
+    lines_until_yield(yield_interval),
+    start_cpu_time(0.0),
+    install_frame(nullptr),
+    raising(nullptr),
+    thread_id(0) {
+}
+
+ScriptBudget::~ScriptBudget() {
+    std::lock_guard<std::mutex> lock(budgets_lock);
+
+    auto registered(budgets.find(thread_id));
+    if (registered != std::end(budgets) && registered->second.expired()) {
+        budgets.erase(registered);
+    }
+}
+
+double ScriptBudget::get_thread_cpu_time() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return double(time.tv_sec) + double(time.tv_nsec) / 1e9;
+}
+
+void ScriptBudget::install(std::shared_ptr<ScriptBudget> budget) {
+    budget->start_cpu_time = get_thread_cpu_time();
+    // Hold on to the frame, so that a new frame can't be mistaken for it.
+    budget->install_frame = PyEval_GetFrame();
+    Py_XINCREF(budget->install_frame);
+    budget->thread_id = PyThread_get_thread_ident();
+
+    {
+        std::lock_guard<std::mutex> lock(budgets_lock);
+        budgets[budget->thread_id] = budget;
+    }
+
+    // The trace function keeps the budget alive until it is removed,
+    // which happens at the latest when the thread state is cleared.
+    PyObject *capsule(PyCapsule_New(new std::shared_ptr<ScriptBudget>(budget), nullptr, [] (PyObject *capsule) {
+        auto budget(static_cast<std::shared_ptr<ScriptBudget> *>(PyCapsule_GetPointer(capsule, nullptr)));
+        Py_CLEAR((*budget)->install_frame);
+        delete budget;
+    }));
+    PyEval_SetTrace(&ScriptBudget::trace, capsule);
+    Py_DECREF(capsule);
+}
+
+void ScriptBudget::uninstall() {
+    // Releases the capsule, and with it the budget
+    PyEval_SetTrace(nullptr, nullptr);
+}
+
+void ScriptBudget::halt() {
+    raising = halt_exception;
+}
+
+bool ScriptBudget::halt_thread(long thread_id) {
+    std::shared_ptr<ScriptBudget> budget;
+    {
+        std::lock_guard<std::mutex> lock(budgets_lock);
+
+        auto registered(budgets.find(thread_id));
+        if (registered != std::end(budgets)) {
+            budget = registered->second.lock();
+        }
+    }
+
+    if (!budget) {
+        return false;
+    }
+
+    budget->halt();
+    return true;
+}
+
+bool ScriptBudget::should_raise_in(PyFrameObject *frame) {
+    if (!install_frame) {
+        return true;
+    }
+
+    // Walk up to the frame the budget was installed from, so that the
+    // code which installed it can clean up once the exception gets back
+    // to it.
+    if (frame == install_frame) {
+        return false;
+    }
+#if PY_VERSION_HEX >= 0x03090000
+    PyFrameObject *ancestor(PyFrame_GetBack(frame));
+    while (ancestor) {
+        bool found(ancestor == install_frame);
+        PyFrameObject *next(found ? nullptr : PyFrame_GetBack(ancestor));
+        Py_DECREF(ancestor);
+        if (found) {
+            return true;
+        }
+        ancestor = next;
+    }
+#else
+    for (PyFrameObject *ancestor = frame->f_back; ancestor; ancestor = ancestor->f_back) {
+        if (ancestor == install_frame) {
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+int ScriptBudget::trace(PyObject *capsule, PyFrameObject *frame, int what, PyObject *) {
+    if (what != PyTrace_LINE) {
+        return 0;
+    }
+
+    ScriptBudget &budget(**static_cast<std::shared_ptr<ScriptBudget> *>(PyCapsule_GetPointer(capsule, nullptr)));
+
+    PyObject *exception(budget.raising);
+    if (exception && budget.should_raise_in(frame)) {
+        PyErr_SetNone(exception);
+        return -1;
+    }
+
+    if (--budget.lines_until_yield > 0) {
+        return 0;
+    }
+    budget.lines_until_yield = budget.yield_interval;
+
+    if (!exception && budget.cpu_budget > 0.0
+        && get_thread_cpu_time() - budget.start_cpu_time > budget.cpu_budget) {
+        budget.raising = budget.timeout_exception;
+        if (budget.should_raise_in(frame)) {
+            PyErr_SetNone(budget.timeout_exception);
+            return -1;
+        }
+    }
+
+    // Let go of the GIL so that, if the engine is waiting for it, it
+    // gets it now rather than after the switch interval.
+    Py_BEGIN_ALLOW_THREADS
+    std::this_thread::yield();
+    Py_END_ALLOW_THREADS
+
+    return 0;
+}
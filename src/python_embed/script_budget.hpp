@@ -0,0 +1,142 @@
+#ifndef SCRIPT_BUDGET_H
+#define SCRIPT_BUDGET_H
+
+#include "python_embed_headers.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+///
+/// Limits a Python thread, using a trace function which CPython calls
+/// before every line the thread runs.
+///
+/// Every yield_interval lines the thread lets go of the GIL for a moment,
+/// so a script spinning in a loop can't keep the engine waiting for the
+/// interpreter's switch interval on every event.
+///
+/// Once the thread is halted, or has used more CPU time than its budget,
+/// every line below the frame the budget was installed from raises an
+/// exception. Unlike an asynchronous exception, this can't be swallowed
+/// by a bare except in the script, as the next line raises it again.
+///
+class ScriptBudget {
+private:
+    ///
+    /// Raised once halted. Borrowed, so it must outlive the budget.
+    ///
+    PyObject *halt_exception;
+
+    ///
+    /// Raised once the CPU time budget has been used. Borrowed, so it
+    /// must outlive the budget.
+    ///
+    PyObject *timeout_exception;
+
+    ///
+    /// CPU time, in seconds, the thread may use. Not limited if 0.
+    ///
+    double cpu_budget;
+
+    int yield_interval;
+    int lines_until_yield;
+
+    ///
+    /// Thread CPU time, in seconds, when the budget was installed.
+    ///
+    double start_cpu_time;
+
+    ///
+    /// The Python frame the budget was installed from. Only the frames
+    /// it calls raise, or every frame if this is nullptr.
+    ///
+    PyFrameObject *install_frame;
+
+    ///
+    /// The exception to raise, or nullptr if the thread can carry on.
+    ///
+    std::atomic<PyObject *> raising;
+
+    ///
+    /// The CPython thread ID the budget is installed on.
+    ///
+    long thread_id;
+
+    ///
+    /// Installed budgets by CPython thread ID, for halt_thread.
+    ///
+    static std::map<long, std::weak_ptr<ScriptBudget>> budgets;
+    static std::mutex budgets_lock;
+
+    ///
+    /// The trace function given to PyEval_SetTrace. The trace object is
+    /// a capsule holding a std::shared_ptr<ScriptBudget>.
+    ///
+    static int trace(PyObject *capsule, PyFrameObject *frame, int what, PyObject *arg);
+
+    ///
+    /// Whether the frame is below the frame the budget was installed from.
+    ///
+    bool should_raise_in(PyFrameObject *frame);
+
+    ///
+    /// Get the CPU time used by the calling thread, in seconds. Time
+    /// spent waiting, such as for a character to finish moving, isn't
+    /// counted.
+    ///
+    static double get_thread_cpu_time();
+
+public:
+    ///
+    /// @param halt_exception
+    ///     The exception type raised once halted.
+    ///
+    /// @param timeout_exception
+    ///     The exception type raised once the CPU time budget is used.
+    ///
+    /// @param cpu_budget
+    ///     The CPU time, in seconds, the thread may use, or 0 for no limit.
+    ///
+    /// @param yield_interval
+    ///     How many lines to run between letting go of the GIL.
+    ///
+    ScriptBudget(PyObject *halt_exception, PyObject *timeout_exception, double cpu_budget, int yield_interval);
+    ~ScriptBudget();
+
+    ScriptBudget(ScriptBudget const&) = delete;
+    void operator=(ScriptBudget const&) = delete;
+
+    ///
+    /// Start limiting the calling thread. The GIL must be held.
+    ///
+    /// The budget stays installed until the thread exits or another
+    /// trace function is installed.
+    ///
+    static void install(std::shared_ptr<ScriptBudget> budget);
+
+    ///
+    /// Stop limiting the calling thread, removing its trace function.
+    /// The GIL must be held.
+    ///
+    static void uninstall();
+
+    ///
+    /// Make the thread raise halt_exception from its next line.
+    ///
+    /// Thread safe.
+    ///
+    void halt();
+
+    ///
+    /// Halt the thread with the given CPython thread ID, if it has a
+    /// budget installed.
+    ///
+    /// Thread safe.
+    ///
+    /// @return Whether the thread had a budget.
+    ///
+    static bool halt_thread(long thread_id);
+};
+
+#endif
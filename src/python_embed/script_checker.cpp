@@ -0,0 +1,150 @@
+#include "python_embed_headers.hpp"
+
+#include <boost/python.hpp>
+#include <glog/logging.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "event_manager.hpp"
+#include "interpreter_context.hpp"
+#include "locks.hpp"
+#include "script_checker.hpp"
+
+namespace py = boost::python;
+
+ScriptChecker::ScriptChecker(InterpreterContext interpreter_context):
+    interpreter_context(interpreter_context),
+    stopping(false),
+    thread(&ScriptChecker::run, this) {
+}
+
+ScriptChecker::~ScriptChecker() {
+    {
+        std::lock_guard<std::mutex> guard(checker_lock);
+        stopping = true;
+        jobs.clear();
+    }
+    jobs_changed.notify_all();
+    thread.join();
+
+    // The code objects can only be released with the GIL.
+    lock::GIL lock_gil(interpreter_context, "ScriptChecker::~ScriptChecker");
+    cache.clear();
+}
+
+void ScriptChecker::check(std::string script, std::function<void (Result)> callback) {
+    Result result;
+    if (lookup(script, result)) {
+        EventManager::get_instance()->add_event([callback, result] () {
+            callback(result);
+        });
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(checker_lock);
+        jobs.push_back(Job{script, callback});
+    }
+    jobs_changed.notify_one();
+}
+
+bool ScriptChecker::lookup(const std::string &script, Result &result) {
+    std::lock_guard<std::mutex> guard(checker_lock);
+
+    auto entry = cache.find(std::hash<std::string>()(script));
+    if (entry == std::end(cache) || entry->second.script != script) {
+        return false;
+    }
+
+    result = entry->second.result;
+    return true;
+}
+
+py::object ScriptChecker::get_code(const std::string &script) {
+    std::lock_guard<std::mutex> guard(checker_lock);
+
+    auto entry = cache.find(std::hash<std::string>()(script));
+    if (entry == std::end(cache) || entry->second.script != script) {
+        return py::object();
+    }
+
+    return entry->second.code;
+}
+
+void ScriptChecker::run() {
+    lock::ThreadState threadstate(interpreter_context);
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard(checker_lock);
+            jobs_changed.wait(guard, [this] () { return stopping || !jobs.empty(); });
+
+            if (stopping) {
+                return;
+            }
+
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        // The same script may have been queued more than once while typing.
+        Result result;
+        if (!lookup(job.script, result)) {
+            lock::ThreadGIL lock_thread(threadstate);
+            result = compile(job.script);
+        }
+
+        auto callback(job.callback);
+        EventManager::get_instance()->add_event([callback, result] () {
+            callback(result);
+        });
+    }
+}
+
+ScriptChecker::Result ScriptChecker::compile(const std::string &script) {
+    Entry entry{script, Result{true, 0, ""}, py::object()};
+
+    // "<string>" matches the file name given by exec, so tracebacks
+    // from cached code look the same as before.
+    PyObject *code = Py_CompileString(script.c_str(), "<string>", Py_file_input);
+
+    if (code) {
+        entry.code = py::object(py::handle<>(code));
+    }
+    else if (PyErr_ExceptionMatches(PyExc_SyntaxError)) {
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+        py::handle<> htype(type), hvalue(py::allow_null(value)), htraceback(py::allow_null(traceback));
+
+        entry.result.valid = false;
+        try {
+            py::object error(hvalue);
+
+            py::extract<int> lineno(error.attr("lineno"));
+            if (lineno.check()) {
+                entry.result.line = lineno();
+            }
+            entry.result.message = py::extract<std::string>(py::str(error.attr("msg")));
+        }
+        catch (py::error_already_set &) {
+            PyErr_Clear();
+            entry.result.message = "invalid syntax";
+        }
+    }
+    else {
+        entry.result.valid = false;
+        entry.result.message = lock::get_python_error_message();
+    }
+
+    VLOG(2) << "Checked script: " << (entry.result.valid ? "valid" : entry.result.message);
+
+    std::lock_guard<std::mutex> guard(checker_lock);
+    if (cache.size() >= max_cached) {
+        cache.clear();
+    }
+    cache[std::hash<std::string>()(script)] = entry;
+
+    return entry.result;
+}
@@ -0,0 +1,154 @@
+#ifndef SCRIPT_CHECKER_H
+#define SCRIPT_CHECKER_H
+
+#include "python_embed_headers.hpp"
+
+#include <boost/python.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "interpreter_context.hpp"
+#include "locks.hpp"
+
+///
+/// Compiles player scripts in the background so that syntax errors can be
+/// shown in the PyScripter while the player is typing, without stalling the
+/// game loop.
+///
+/// Results are cached by a hash of the script text. The compiled code objects
+/// are kept too, so that running a script which has already been checked does
+/// not parse it a second time.
+///
+class ScriptChecker {
+    public:
+        ///
+        /// The outcome of compiling a script.
+        ///
+        struct Result {
+            ///
+            /// Whether the script compiled.
+            ///
+            bool valid;
+
+            ///
+            /// The line (starting at 1) of the syntax error,
+            /// or 0 if it is unknown or there is no error.
+            ///
+            int line;
+
+            ///
+            /// The Python error message, empty if the script is valid.
+            ///
+            std::string message;
+        };
+
+        ///
+        /// Start the background checking thread.
+        ///
+        /// @param interpreter_context
+        ///     The interpreter to compile the scripts with.
+        ///
+        ScriptChecker(InterpreterContext interpreter_context);
+
+        ///
+        /// Stop the background thread and release the cached code objects.
+        /// Pending checks are discarded.
+        ///
+        ~ScriptChecker();
+
+        ///
+        /// Queue a script to be checked. The callback is run on the main
+        /// thread through the EventManager once the result is known.
+        ///
+        /// @param script
+        ///     The script source.
+        ///
+        /// @param callback
+        ///     Function given the result of the check.
+        ///
+        void check(std::string script, std::function<void (Result)> callback);
+
+        ///
+        /// Look up a previous result without compiling.
+        /// Does not need the GIL.
+        ///
+        /// @param script
+        ///     The script source.
+        ///
+        /// @param result
+        ///     Set to the cached result, if there is one.
+        ///
+        /// @return
+        ///     Whether the script has been checked before.
+        ///
+        bool lookup(const std::string &script, Result &result);
+
+        ///
+        /// Get the compiled code object of a script which has already been
+        /// checked. The GIL must be held.
+        ///
+        /// @param script
+        ///     The script source.
+        ///
+        /// @return
+        ///     The code object, or None if the script has not been checked
+        ///     or does not compile.
+        ///
+        boost::python::object get_code(const std::string &script);
+
+    private:
+        ///
+        /// A cached check. The script is kept to guard against hash collisions.
+        ///
+        struct Entry {
+            std::string script;
+            Result result;
+            boost::python::object code;
+        };
+
+        ///
+        /// A queued check.
+        ///
+        struct Job {
+            std::string script;
+            std::function<void (Result)> callback;
+        };
+
+        ///
+        /// Largest number of scripts to keep compiled before the cache
+        /// is emptied. Only the scripts in the PyScripter tabs are ever
+        /// checked, so this is rarely reached.
+        ///
+        static const std::size_t max_cached = 64;
+
+        ///
+        /// Main loop of the background thread.
+        ///
+        void run();
+
+        ///
+        /// Compile a script and store the result.
+        /// The GIL must be held.
+        ///
+        Result compile(const std::string &script);
+
+        InterpreterContext interpreter_context;
+
+        ///
+        /// Guards the job queue, the cache and the stopping flag.
+        ///
+        std::mutex checker_lock;
+        std::condition_variable jobs_changed;
+        std::deque<Job> jobs;
+        std::unordered_map<std::size_t, Entry> cache;
+        bool stopping;
+
+        std::thread thread;
+};
+
+#endif
@@ -25,6 +25,7 @@ BOOST_PYTHON_MODULE(wrapper_functions) {
         .def("move_west",         &Entity::move_west)
         .def("move_north",        &Entity::move_north)
         .def("move_south",        &Entity::move_south)
+        .def("move_path",         &Entity::move_path)
         .def("is_moving",         &Entity::is_moving)
         .def("print_debug",       &Entity::py_print_debug)
         .def("read_message",      &Entity::read_message)
@@ -58,6 +59,7 @@ BOOST_PYTHON_MODULE(wrapper_functions) {
         .def("show_external_script_help",     &GameEngine::show_external_script_help)
         .def("close_external_script_help",     &GameEngine::close_external_script_help)
         .def("show_dialogue_with_options",     &GameEngine::show_dialogue_with_options)
+        .def("prerender_dialogue",     &GameEngine::prerender_dialogue)
         .def("get_config",        &GameEngine::get_config)
         .def("change_map",        &GameEngine::change_map)
         .def("get_tile_type",     &GameEngine::get_tile_type)
@@ -85,6 +87,21 @@ BOOST_PYTHON_MODULE(wrapper_functions) {
         .def("clear_scripter",    &GameEngine::clear_scripter)
         .def("get_script",        &GameEngine::get_script)
         .def("get_external_script", &GameEngine::get_external_script)
+        .def("get_compiled_script", &GameEngine::get_compiled_script)
+        .def("get_save_data",     &GameEngine::get_save_data)
+        .def("has_save_data",     &GameEngine::has_save_data)
+        .def("set_save_data",     &GameEngine::set_save_data)
+        .def("flush_save",        &GameEngine::flush_save)
+        .def("load_dialogue",     &GameEngine::load_dialogue)
+        .def("get_dialogue_language", &GameEngine::get_dialogue_language)
+        .def("get_dialogue",      &GameEngine::get_dialogue)
+        .def("limit_script_thread", &GameEngine::limit_script_thread)
+        .def("limit_level_thread", &GameEngine::limit_level_thread)
+        .def("limit_coroutine_step", &GameEngine::limit_coroutine_step)
+        .def("unlimit_coroutine_step", &GameEngine::unlimit_coroutine_step)
+        .def("halt_script_thread", &GameEngine::halt_script_thread)
+        .def("export_profile_csv", &GameEngine::export_profile_csv)
+        .def("export_profile_trace", &GameEngine::export_profile_trace)
         .def("print_terminal",    &GameEngine::print_terminal)
         .def("get_terminal_text", &GameEngine::get_terminal_text)
         .def("get_objects_at",    &GameEngine::get_objects_at)
@@ -95,6 +112,8 @@ BOOST_PYTHON_MODULE(wrapper_functions) {
         .def("trigger_run",       &GameEngine::trigger_run)
         .def("get_run_script",    &GameEngine::get_run_script)
         .def("is_solid",          &GameEngine::is_solid)
+        .def("find_path",         &GameEngine::find_path)
+        .def("get_flow_direction", &GameEngine::get_flow_direction)
         .def("add_event",         &GameEngine::add_event)
         .def("set_player_name",   &GameEngine::set_player_name)
         .def("get_player_name",   &GameEngine::get_player_name)
@@ -62,6 +62,7 @@ extern "C" {
 #include "lifeline.hpp"
 #include "lifeline_controller.hpp"
 #include "mainwindow.h"
+#include "map_viewer.hpp"
 #include "parsingfunctions.hpp"
 
 #ifdef USE_GLES
@@ -566,6 +567,9 @@ void GameWindow::update() {
         case SDL_WINDOWEVENT:
             window = windows[event.window.windowID];
 
+            // The last frame may have been lost or covered, so draw it again.
+            MapViewer::invalidate();
+
             // Instead of reinitialising on every event, do it ater we have
             // scanned the event queue in full.
             // Should focus events be included?
@@ -73,6 +73,7 @@ using namespace std;
 #include <Qsci/qsciapis.h>
 #include <Qsci/qsciscintilla.h>
 #include <Qsci/qscilexerpython.h>
+#include <Qsci/qscistyle.h>
 
 #include "config.hpp"
 #include "mainwindow.h"
@@ -80,6 +81,8 @@ using namespace std;
 #include "h_tab_bar.hpp"
 #include "input_handler.hpp"
 #include "input_manager.hpp"
+#include "engine.hpp"
+#include "script_checker.hpp"
 #include "event_manager.hpp"
 
 // Game window stuff
@@ -88,6 +91,7 @@ using namespace std;
 #include <glog/logging.h>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <glm/vec2.hpp>
@@ -207,11 +211,22 @@ MainWindow::MainWindow(GameMain *exGame):
     terminal = new QWidget;
     terminal->setLayout(terminalLayout);
 
+    syntaxStyle = new QsciStyle(-1, "Syntax error", QColor("red"), QColor("mistyrose"), font);
+
     for(int ws = 0; ws < workspace_max; ws++)
     {
         initWorkspace(workspaces[ws], ws);
+        syntaxDirty[ws] = true;
+        connect(workspaces[ws],SIGNAL(textChanged()),this,SLOT (scriptChanged()));
     }
 
+    //Check the scripts for syntax errors once typing has paused for half a second
+    checkTimer = new QTimer(this);
+    checkTimer->setSingleShot(true);
+    checkTimer->setInterval(500);
+    connect(checkTimer, SIGNAL(timeout()), this, SLOT(checkScripts()));
+    checkTimer->start();
+
     // Setup draggable splitter for script embedWindow and terminal
     splitter = new QSplitter(Qt::Horizontal);
 
@@ -352,6 +367,8 @@ MainWindow::~MainWindow()
     delete windowLayout;
 
     delete eventTimer;
+    delete checkTimer;
+    delete syntaxStyle;
 
     LOG(INFO) << "Destructed MainWindow" << std::endl;
 
@@ -388,6 +405,9 @@ void MainWindow::initWorkspace(QsciScintilla* ws, int i)
     ws->setCaretWidth(5);
     ws->setMarginWidth(1,5);
     ws->setCaretForegroundColor("deep pink");
+    ws->markerDefine(QsciScintilla::Background, syntaxMarker);
+    ws->setMarkerBackgroundColor(QColor("mistyrose"), syntaxMarker);
+    ws->setAnnotationDisplay(QsciScintilla::AnnotationBoxed);
 
     //Read 9 python scripts and display in scintilla widget
 
@@ -962,6 +982,56 @@ void MainWindow::runCode(int script)
     setGameFocus();
 }
 
+//Called whenever the text of a workspace changes
+//Restarts the timer so that scripts are only checked when the player stops typing
+void MainWindow::scriptChanged()
+{
+    for (int ws = 0; ws < workspace_max; ws++)
+    {
+        if (workspaces[ws] == sender())
+        {
+            syntaxDirty[ws] = true;
+        }
+    }
+    checkTimer->start();
+}
+
+//Send the edited scripts to be compiled on the script checker's thread
+//The results come back through the event manager, so the game loop never waits on them
+void MainWindow::checkScripts()
+{
+    ScriptChecker *checker = Engine::get_script_checker();
+    if (checker == nullptr) return;
+
+    for (int i = 0; i < workspace_max; i++)
+    {
+        if (!syntaxDirty[i]) continue;
+        syntaxDirty[i] = false;
+
+        QsciScintilla *ws = workspaces[i];
+        std::string script = ws->text().toStdString();
+        checker->check(script, [this, ws, script] (ScriptChecker::Result result) {
+            //Ignore the result if the script has been edited since
+            if (ws->text().toStdString() != script) return;
+            showSyntaxResult(ws, result.valid, result.line, result.message);
+        });
+    }
+}
+
+//Highlight the line with a syntax error and explain it underneath,
+//or clear the highlight if the script is valid
+void MainWindow::showSyntaxResult(QsciScintilla* ws, bool valid, int line, std::string message)
+{
+    ws->markerDeleteAll(syntaxMarker);
+    ws->clearAnnotations();
+    if (valid) return;
+
+    //Python counts lines from one, scintilla from zero
+    int ws_line = std::max(line - 1, 0);
+    ws->markerAdd(ws_line, syntaxMarker);
+    ws->annotate(ws_line, QString::fromStdString("SyntaxError: " + message), *syntaxStyle);
+}
+
 //Called when the speed button is clicked
 void MainWindow::clickSpeed()
 {
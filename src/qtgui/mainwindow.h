@@ -38,6 +38,7 @@ class QAction;
 class QMenu;
 class QsciScintilla;
 class QsciAPIs;
+class QsciStyle;
 class QProcess;
 class QTextEdit;
 class QSplitter;
@@ -107,6 +108,8 @@ private slots:
     void clearTerminal();
     void clickRun();
     void clickSpeed();
+    void scriptChanged();
+    void checkScripts();
 
 private:
     void initWorkspace(QsciScintilla* ws, int i);
@@ -114,6 +117,7 @@ private:
     std::string number_name(int);
     std::string workspaceFilename(QsciScintilla* text);
     QsciScintilla* filenameToWorkspace(std::string filename);
+    void showSyntaxResult(QsciScintilla* ws, bool valid, int line, std::string message);
 
     QsciLexerPython *lexer;
 
@@ -129,6 +133,15 @@ private:
     QPushButton *buttonIn[workspace_max];
     QPushButton *buttonOut[workspace_max];
 
+    //Marker used to highlight the line of a syntax error
+    static const int syntaxMarker = 1;
+    //Style of the annotation explaining a syntax error
+    QsciStyle *syntaxStyle;
+    //Workspaces edited since they were last checked for syntax errors
+    bool syntaxDirty[workspace_max];
+    //Waits for typing to pause before checking the edited workspaces
+    QTimer *checkTimer;
+
     QTextEdit *terminalDisplay;
     QSplitter *splitter;
     QPushButton *buttonRun;
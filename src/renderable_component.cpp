@@ -3,6 +3,7 @@
 
 #include <glog/logging.h>
 
+#include "map_viewer.hpp"
 #include "shader.hpp"
 #include "texture_atlas.hpp"
 #include "renderable_component.hpp"
@@ -31,6 +32,7 @@ void RenderableComponent::set_vertex_data(GLfloat* new_vertex_data, size_t data_
     delete[] vertex_data;
     vertex_data = new_vertex_data;
     vertex_data_size = data_size;
+    MapViewer::invalidate();
 
     //Get current shader
     GLint id;
@@ -54,12 +56,14 @@ void RenderableComponent::set_vertex_data(GLfloat* new_vertex_data, size_t data_
 
 void RenderableComponent::set_texture(std::shared_ptr<TextureAtlas> texture_atlas) {
     this->texture_atlas = texture_atlas;
+    MapViewer::invalidate();
 }
 
 void RenderableComponent::set_texture_coords_data(GLfloat* new_texture_data, size_t data_size, bool is_dynamic) {
     delete[] texture_coords_data;
     texture_coords_data = new_texture_data;
     texture_coords_data_size = data_size;
+    MapViewer::invalidate();
     //Get current shader
     GLint id;
     glGetIntegerv(GL_CURRENT_PROGRAM, &id);
@@ -124,6 +128,8 @@ void RenderableComponent::release_shader() {
 }
 
 void RenderableComponent::update_vertex_buffer(GLintptr offset, size_t size, GLfloat* data) {
+    MapViewer::invalidate();
+
     //Get current shader
     GLint id;
     glGetIntegerv(GL_CURRENT_PROGRAM, &id);
@@ -141,6 +147,8 @@ void RenderableComponent::update_vertex_buffer(GLintptr offset, size_t size, GLf
 }
 
 void RenderableComponent::update_texture_buffer(GLintptr offset, size_t size, GLfloat* data) {
+    MapViewer::invalidate();
+
     //Get current shader
     GLint id;
     glGetIntegerv(GL_CURRENT_PROGRAM, &id);
@@ -0,0 +1,114 @@
+#include "catch.hpp"
+#include "collision_grid.hpp"
+
+SCENARIO("CollisionGrid counts blockers on a tile", "[collision_grid][block]" ) {
+
+    GIVEN("an empty grid") {
+        CollisionGrid grid(70, 3);
+
+        THEN("no tile is solid") {
+            REQUIRE(!grid.is_solid(0, 0));
+            REQUIRE(!grid.is_solid(69, 2));
+            REQUIRE(grid.get_block_count(5, 1) == 0);
+        }
+
+        WHEN("a tile is blocked twice") {
+            unsigned int version(grid.get_version());
+            REQUIRE(grid.block(65, 1));
+            REQUIRE(grid.block(65, 1));
+
+            THEN("it is solid, and only it") {
+                REQUIRE(grid.is_solid(65, 1));
+                REQUIRE(grid.get_block_count(65, 1) == 2);
+                REQUIRE(!grid.is_solid(64, 1));
+                REQUIRE(!grid.is_solid(65, 0));
+                REQUIRE(!grid.is_terrain_solid(65, 1));
+            }
+
+            THEN("the version changed once") {
+                REQUIRE(grid.get_version() == version + 1);
+            }
+
+            THEN("it stays solid until both blockers are removed") {
+                REQUIRE(grid.unblock(65, 1));
+                REQUIRE(grid.is_solid(65, 1));
+                REQUIRE(grid.unblock(65, 1));
+                REQUIRE(!grid.is_solid(65, 1));
+                REQUIRE(grid.get_version() == version + 2);
+            }
+        }
+
+        WHEN("a tile which is not blocked is unblocked") {
+            bool unblocked(grid.unblock(3, 2));
+
+            THEN("it fails, and the count doesn't wrap around") {
+                REQUIRE(!unblocked);
+                REQUIRE(grid.get_block_count(3, 2) == 0);
+                REQUIRE(!grid.is_solid(3, 2));
+            }
+        }
+    }
+}
+
+SCENARIO("CollisionGrid combines terrain and blockers", "[collision_grid][terrain]" ) {
+
+    GIVEN("a grid with a solid terrain tile") {
+        CollisionGrid grid(4, 4);
+        grid.set_terrain(1, 2, true);
+
+        THEN("the tile is solid terrain") {
+            REQUIRE(grid.is_solid(1, 2));
+            REQUIRE(grid.is_terrain_solid(1, 2));
+        }
+
+        WHEN("the tile is blocked and unblocked") {
+            REQUIRE(grid.block(1, 2));
+            REQUIRE(grid.unblock(1, 2));
+
+            THEN("it is still solid") {
+                REQUIRE(grid.is_solid(1, 2));
+            }
+        }
+
+        WHEN("the terrain is cleared while the tile is blocked") {
+            REQUIRE(grid.block(1, 2));
+            grid.set_terrain(1, 2, false);
+
+            THEN("the tile is solid until it is unblocked") {
+                REQUIRE(grid.is_solid(1, 2));
+                REQUIRE(!grid.is_terrain_solid(1, 2));
+                REQUIRE(grid.unblock(1, 2));
+                REQUIRE(!grid.is_solid(1, 2));
+            }
+        }
+    }
+}
+
+SCENARIO("CollisionGrid ignores tiles out of bounds", "[collision_grid][bounds]" ) {
+
+    GIVEN("a grid") {
+        CollisionGrid grid(4, 3);
+
+        THEN("only tiles on it are in bounds") {
+            REQUIRE(grid.in_bounds(0, 0));
+            REQUIRE(grid.in_bounds(3, 2));
+            REQUIRE(!grid.in_bounds(-1, 0));
+            REQUIRE(!grid.in_bounds(0, -1));
+            REQUIRE(!grid.in_bounds(4, 0));
+            REQUIRE(!grid.in_bounds(0, 3));
+        }
+
+        WHEN("tiles out of bounds are changed") {
+            unsigned int version(grid.get_version());
+            bool blocked(grid.block(4, 0));
+            bool unblocked(grid.unblock(-1, 2));
+            grid.set_terrain(0, 3, true);
+
+            THEN("nothing happens") {
+                REQUIRE(!blocked);
+                REQUIRE(!unblocked);
+                REQUIRE(grid.get_version() == version);
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/vec2.hpp>
+
+#include "catch.hpp"
+#include "collision_grid.hpp"
+#include "pathfinder.hpp"
+
+SCENARIO("Pathfinder steps towards the nearest target", "[pathfinder][flow]" ) {
+
+    GIVEN("a grid with a wall between two columns") {
+        // Column 2 is solid apart from the row with y = 2. Drawn with
+        // y growing down the page:
+        //  y = 0  . . # . .
+        //  y = 1  . . # . .
+        //  y = 2  . . . . .
+        CollisionGrid grid(5, 3);
+        grid.set_terrain(2, 0, true);
+        grid.set_terrain(2, 1, true);
+        Pathfinder pathfinder(&grid);
+
+        std::vector<glm::ivec2> targets{glm::ivec2(4, 0)};
+
+        THEN("the step goes around the wall") {
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 0), targets) == glm::ivec2(0, 1));
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 2), targets) == glm::ivec2(1, 0));
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(3, 0), targets) == glm::ivec2(1, 0));
+        }
+
+        THEN("there is no step from a target") {
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(4, 0), targets) == glm::ivec2(0, 0));
+        }
+
+        THEN("the nearest of several targets is chosen") {
+            std::vector<glm::ivec2> both{glm::ivec2(4, 0), glm::ivec2(0, 0)};
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 0), both) == glm::ivec2(-1, 0));
+        }
+
+        THEN("targets off the map are ignored") {
+            std::vector<glm::ivec2> off_map{glm::ivec2(-1, 0), glm::ivec2(5, 5)};
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 0), off_map) == glm::ivec2(0, 0));
+        }
+
+        WHEN("the gap in the wall is blocked") {
+            REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 0), targets) == glm::ivec2(0, 1));
+            REQUIRE(grid.block(2, 2));
+
+            THEN("the cached field is dropped and there is no way there") {
+                REQUIRE(pathfinder.get_flow_direction(glm::ivec2(1, 0), targets) == glm::ivec2(0, 0));
+            }
+        }
+    }
+}
+
+SCENARIO("Pathfinder finds shortest paths", "[pathfinder][path]" ) {
+
+    GIVEN("a grid with a wall between two columns") {
+        CollisionGrid grid(5, 3);
+        grid.set_terrain(2, 0, true);
+        grid.set_terrain(2, 1, true);
+        Pathfinder pathfinder(&grid);
+
+        WHEN("a path is found around the wall") {
+            std::vector<glm::ivec2> path(pathfinder.find_path(glm::ivec2(1, 0), glm::ivec2(3, 0)));
+
+            THEN("it takes the shortest way, through the gap") {
+                REQUIRE(path.size() == 6);
+
+                glm::ivec2 tile(1, 0);
+                for (auto step : path) {
+                    tile = tile + step;
+                    REQUIRE(grid.in_bounds(tile.x, tile.y));
+                    REQUIRE(!grid.is_solid(tile.x, tile.y));
+                }
+                REQUIRE(tile == glm::ivec2(3, 0));
+            }
+        }
+
+        THEN("a blocked start and goal can be used") {
+            REQUIRE(grid.block(0, 0));
+            REQUIRE(grid.block(0, 2));
+            REQUIRE(pathfinder.find_path(glm::ivec2(0, 0), glm::ivec2(0, 2)).size() == 2);
+        }
+
+        THEN("there is no path to the same tile or off the map") {
+            REQUIRE(pathfinder.find_path(glm::ivec2(1, 1), glm::ivec2(1, 1)).empty());
+            REQUIRE(pathfinder.find_path(glm::ivec2(1, 1), glm::ivec2(9, 1)).empty());
+        }
+
+        WHEN("the gap is blocked") {
+            REQUIRE(grid.block(2, 2));
+
+            THEN("there is no path") {
+                REQUIRE(pathfinder.find_path(glm::ivec2(1, 0), glm::ivec2(3, 0)).empty());
+            }
+        }
+    }
+}
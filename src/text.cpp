@@ -1,19 +1,4 @@
-// //////////////////////////////////////////////////////////////
-// //////////////////////// CURRENT BUGS ////////////////////////
-// //////////////////////////////////////////////////////////////
-// Possible SDL_ttf bug when rendering certain first characters.
-//      Workaround is to append and prepend a space character to lines.
-//      See render(): border, safe, safe_str.
-//
-
-// Behaviour modifiers (defines):
-//  TEXT_SAFE_SURFACE
-//      Text can be rendered less directly by defining this. This will
-//      copy the surface into another surface of an explicitly defined
-//      format - which is slow, but is safer use. In theory, disabling
-//      this also works perfectly though, giving a performance boost by
-//      directly reading off the text.
-
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <functional>
@@ -22,18 +7,22 @@
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include <glog/logging.h>
 
 #include "callback.hpp"
+#include "font_atlas.hpp"
 #include "game_window.hpp"
-#include "image.hpp"
+#include "map_viewer.hpp"
 #include "shader.hpp"
 #include "text.hpp"
 #include "text_font.hpp"
 
 #define SHADER_VARIABLE_POSITION "position"
 #define SHADER_VARIABLE_TEXTURE  "texture_coord"
+#define SHADER_VARIABLE_COLOUR   "colour"
+#define SHADER_VARIABLE_SMOOTHING "smoothing"
 #define SHADER_LOCATION_POSITION 0
 #define SHADER_LOCATION_TEXTURE  1
 
@@ -56,7 +45,6 @@ static void load_program(GameWindow* window) {
     std::shared_ptr<Shader> shader = shaders.find(window)->second;
     shader->bind_location_to_attribute(SHADER_LOCATION_POSITION, SHADER_VARIABLE_POSITION);
     shader->bind_location_to_attribute(SHADER_LOCATION_TEXTURE, SHADER_VARIABLE_TEXTURE);
-    // shader->bind_location_to_attribute(SHADER_LOCATION_COLOUR, SHADER_VARIABLE_COLOUR);
     shader->link();
 }
 
@@ -75,6 +63,8 @@ Text::Text(GameWindow* window, TextFont font, bool smooth):
     position_from_alignment(false),
     alignment_h(Text::Alignment::LEFT),
     alignment_v(Text::Alignment::TOP),
+    used_width(0),
+    used_height(0),
     smooth(smooth),
     width(0),
     width_ratio(0),
@@ -86,8 +76,10 @@ Text::Text(GameWindow* window, TextFont font, bool smooth):
     y_ratio(0),
     ratio_size(false),
     ratio_position(true),
-    texture(0),
+    rendered_width(0),
+    rendered_height(0),
     vbo(0),
+    vbo_vertices(0),
     font(font),
     window(window),
     resize_callback([this] (GameWindow*) {
@@ -107,7 +99,6 @@ Text::Text(GameWindow* window, TextFont font, bool smooth):
 
 Text::~Text() {
     resize_callback.unregister_everywhere();
-    glDeleteTextures(1, &texture);
     glDeleteBuffers(1, &vbo);
 }
 
@@ -117,6 +108,18 @@ Text::~Text() {
 //      the most C-like function you can get without being C++.
 //      Sorry Joshua.
 void Text::render() {
+    if (!atlas) {
+        window->use_context();
+        atlas = FontAtlas::get_shared(font.filename, false);
+        if (!atlas) {
+            throw Text::RenderException("Unable to load font atlas");
+        }
+    }
+
+    // Glyphs are stored at the atlas size, and scaled to the font size
+    // when drawn.
+    float scale = float(font.size) / float(FontAtlas::base_size);
+
     int width = this->width;
     int height = this->height;
     std::pair<int,int> window_size = window->get_window_size();
@@ -158,22 +161,14 @@ void Text::render() {
     }
 
     int available_width = width;
-    // It took a whole day to discover that there was a bug in
-    // SDL_ttf. Starting with certain characters on certain
-    // fonts seems to break it. :(
-    // As a hack, prepend and (for balance) append a space.
-    int border;
-    TTF_SizeUTF8(font.font, " ", &border, NULL);
-    border *= 2;
 
     // If they are still zero, don't continue.
     if (available_width <= 0) {
         throw Text::RenderException("No available width for rendering text.");
     }
 
-    int line_height = TTF_FontHeight(font.font);
+    int line_height = (int)std::ceil(float(atlas->get_line_height()) * scale);
     int line_number = 0;
-    int lost_lines = 0;
 
     int used_width = 0;
 
@@ -232,9 +227,7 @@ void Text::render() {
             }
             line[l - t] = '\0';
             // Test line length.
-            TTF_SizeUTF8(font.font, line, &line_width, NULL);
-            // Part of SDL_ttf bug workaround.
-            line_width+=border;
+            line_width = atlas->get_width(line, scale);
             if (line_width <= available_width) {
                 if (line_width > used_width) {
                     used_width = line_width;
@@ -274,9 +267,7 @@ void Text::render() {
                         ll = ls;
                         c = line[ls];
                         line[ls] = 0;
-                        TTF_SizeUTF8(font.font, line, &line_width, NULL);
-                        // Part of SDL_ttf bug workaround.
-                        line_width+=border;
+                        line_width = atlas->get_width(line, scale);
                         if (line_width <= available_width) {
                             if (line_width > used_width) {
                                 used_width = line_width;
@@ -324,83 +315,21 @@ void Text::render() {
 
     int used_height = line_count * line_height;
 
-    used_width += border;
-
-    image = Image(used_width, (used_height < height) ? used_height : height, true);
-    uint8_t clear_colour[4] = {rgba[0], rgba[1], rgba[2], 0x00};
-    uint8_t clear_mask[4] = {0xff, 0xff, 0xff, 0xff};
-    image.clear(clear_colour, clear_mask);
-    // image.clear(0xffffff00, 0xffffffff);
-
-    // Render all lines of text.
-    SDL_Color blank;
-    blank.r = blank.g = blank.b = blank.a = 0;
-    SDL_Color colour;
-    colour.r = rgba[0];
-    colour.g = rgba[1];
-    colour.b = rgba[2];
-    colour.a = rgba[3];
+    rendered_width = used_width;
+    rendered_height = (used_height < height) ? used_height : height;
+    if (used_height > height) {
+        LOG(WARNING) << "Text overflow.";
+    }
+
+    // Lay out the glyphs of all lines of text.
+    float atlas_w = float(atlas->get_width());
+    float atlas_h = float(atlas->get_height());
+    float spread = float(FontAtlas::spread) * scale;
+    glyph_vertices.clear();
     lines_scan = lines;
     for (int line_number = 0; line_number < line_count; ++line_number) {
-        // Render line
-        VLOG(2) << "Rendering line of text: \"" << lines_scan << "\".";
-        if (lines_scan[0] == '\0') {
-            // Skip it - it's a new line.
-            lines_scan = &lines_scan[1];
-            continue;
-        }
-
-        SDL_Surface* rendered_line;
-        {
-            // It took a whole day to discover that there was a bug in
-            // SDL_ttf. Starting with certain characters on certain
-            // fonts seems to break it. :(
-            // As a hack, prepend and (for balance) append a space.
-            std::stringstream safe;
-            safe << " " << lines_scan << " ";
-            std::string safe_str(safe.str());
-            if (smooth) {
-                rendered_line = TTF_RenderUTF8_Shaded(font.font, safe_str.c_str(), colour, blank);
-            }
-            else {
-                rendered_line = TTF_RenderUTF8_Solid(font.font, safe_str.c_str(), colour);
-            }
-        }
+        VLOG(2) << "Laying out line of text: \"" << lines_scan << "\".";
 
-        if (rendered_line == nullptr) {
-            LOG(WARNING) << "Cannot render line of text: \"" << lines_scan << "\".";
-            delete[] line;
-            delete[] lines;
-            throw Text::RenderException("Cannot render line of text");
-        }
-
-#ifdef TEXT_SAFE_SURFACE
-        // This surface has a known format.
-        SDL_Surface* compatible = SDL_CreateRGBSurface(0, // Unsed
-                                                       rendered_line->w,
-                                                       rendered_line->h,
-                                                       32,
-                                                       0x00,
-                                                       0x00,
-                                                       0x00,
-                                                       0xff
-                                                       );
-        SDL_FillRect(compatible, NULL, 0);
-        SDL_SetSurfaceBlendMode(rendered_line, SDL_BLENDMODE_NONE);
-        SDL_BlitSurface(rendered_line, NULL, compatible, NULL);
-        SDL_LockSurface(compatible);
-        // pitch is in bytes, not pixels. RGBA = 4 bytes.
-        int jump = compatible->pitch / 4;
-#else
-        SDL_LockSurface(rendered_line);
-        int jump = rendered_line->pitch;
-#endif
-        // "What is this pointless copy?" you might ask.
-        //   Well, it is a suggestion to the c++ compiler that smooth
-        //   will not change throughout this function, so it can
-        //   optimise the if containing _smooth out of the for loop
-        //   entirely, rather than checking it every single iteration.
-        int _smooth = smooth;
         int x_offset;
         int y_offset;
         switch (alignment_h) {
@@ -409,10 +338,10 @@ void Text::render() {
             x_offset = 0;
             break;
         case Alignment::CENTRE:
-            x_offset = (used_width - rendered_line->w) / 2;
+            x_offset = (used_width - atlas->get_width(lines_scan, scale)) / 2;
             break;
         case Alignment::RIGHT:
-            x_offset = used_width - rendered_line->w;
+            x_offset = used_width - atlas->get_width(lines_scan, scale);
             break;
         }
         switch (alignment_v) {
@@ -421,50 +350,59 @@ void Text::render() {
             y_offset = line_number * line_height;
             break;
         case Alignment::CENTRE:
-            y_offset = line_number * line_height - (used_height - image.height) / 2;
+            y_offset = line_number * line_height - (used_height - rendered_height) / 2;
             break;
         case Alignment::BOTTOM:
-            y_offset = line_number * line_height - (used_height - image.height);
+            y_offset = line_number * line_height - (used_height - rendered_height);
             break;
         }
-        // x surface
-        int xs;
-        // y surface
-        int ys;
-        for (ys = 0; ys < rendered_line->h; ++ys) {
-            int yi = ys + y_offset;
-            if (yi >= image.height) {
-                lost_lines++;
-                break;
-            }
-            else if (yi < 0) {
-                continue;
-            }
-            int begin_xs((x_offset >= 0) ? 0 : -x_offset);
-            int end_xs((rendered_line->w < image.width - x_offset) ? rendered_line->w : image.width - x_offset);
-            for (xs = begin_xs; xs < end_xs; ++xs) {
-#ifdef TEXT_SAFE_SURFACE
-                image.flipped_pixels[yi][xs + x_offset].a = (((Uint32*)compatible->pixels)[(ys*jump + xs)]);
-#else
-                if (_smooth) {
-                    image.flipped_pixels[yi][xs + x_offset].a = (((Uint8*)rendered_line->pixels)[(ys*jump + xs)]);
+
+        float pen_x = float(x_offset);
+        const char* scan = lines_scan;
+        while (*scan != '\0') {
+            uint32_t code_point = FontAtlas::next_code_point(scan);
+            const FontAtlas::Glyph &glyph = atlas->get_glyph(code_point);
+
+            // Spaces have no ink to draw.
+            if (code_point != ' ') {
+                float left   = pen_x + float(glyph.left) * scale - spread;
+                float right  = left + float(glyph.w) * scale;
+                float top    = float(y_offset) + float(glyph.top) * scale - spread;
+                float bottom = top + float(glyph.h) * scale;
+                float tex_left   = float(glyph.x) / atlas_w;
+                float tex_right  = float(glyph.x + glyph.w) / atlas_w;
+                float tex_top    = float(glyph.y) / atlas_h;
+                float tex_bottom = float(glyph.y + glyph.h) / atlas_h;
+
+                // Cut off anything outside the text area, as overflowing
+                // lines are hidden.
+                if (top < 0.0f) {
+                    tex_top += (tex_bottom - tex_top) * (-top / (bottom - top));
+                    top = 0.0f;
                 }
-                else {
-                    image.flipped_pixels[yi][xs + x_offset].a = (((Uint8*)rendered_line->pixels)[(ys*jump + xs)]) ? 255 : 0;
+                if (bottom > float(rendered_height)) {
+                    tex_bottom -= (tex_bottom - tex_top) * ((bottom - float(rendered_height)) / (bottom - top));
+                    bottom = float(rendered_height);
+                }
+
+                if (top < bottom) {
+                    // There are 4 vertices in a rectangle, but we use 6
+                    // vertices in 2 triangles to make the rectangle.
+                    GLfloat quad[] = {
+                        // Triangle 1:
+                        left , bottom, tex_left , tex_bottom,
+                        left , top   , tex_left , tex_top   ,
+                        right, top   , tex_right, tex_top   ,
+                        // Triangle 2:
+                        left , bottom, tex_left , tex_bottom,
+                        right, top   , tex_right, tex_top   ,
+                        right, bottom, tex_right, tex_bottom,
+                    };
+                    glyph_vertices.insert(glyph_vertices.end(), std::begin(quad), std::end(quad));
                 }
-#endif
             }
-        }
-#ifdef TEXT_SAFE_SURFACE
-        SDL_UnlockSurface(compatible);
-        SDL_FreeSurface(compatible);
-#else
-        SDL_UnlockSurface(rendered_line);
-#endif
-        SDL_FreeSurface(rendered_line);
-        if (ys < line_height) {
-            LOG(WARNING) << "Text overflow.";
-            break;
+
+            pen_x += float(glyph.advance) * scale;
         }
 
         // Set lines_scan to start next line
@@ -478,34 +416,10 @@ void Text::render() {
     this->used_height = used_height;
     delete[] line;
     delete[] lines;
-    generate_texture();
     dirty_texture = false;
     dirty_vbo = true;
 }
 
-void Text::generate_texture() {
-    if (texture != 0) {
-        glDeleteTextures(1, &texture);
-    }
-
-    glGenTextures(1, &texture);
-
-    if (texture == 0) {
-        LOG(ERROR) << "Error rendering text: Unable to generate GL texture.";
-        throw Text::RenderException("Unable to generate GL texture");
-    }
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    // For some STUPID reason, GL ES seems to be forcing me to waster
-    // RGB channels for padding, on a system with little memory.
-    // Look into this later.
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.store_width, image.store_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
 
 void Text::generate_vbo() {
     if (dirty_texture) {
@@ -520,67 +434,49 @@ void Text::generate_vbo() {
         }
     }
 
-    std::pair<float, float> ratio_xy = get_top_left_ratio();
-    std::pair<float, float> ratio_wh = get_rendered_size_ratio();
+    std::pair<int, int> top_left = get_top_left();
+    std::pair<int, int> window_size = window->get_window_size();
     // We are working with opengl coordinates where we strech from -1.0
     // to 1.0 across the window.
-    float rx = ratio_xy.first * 2.0f - 1.0f;
-    float ry = ratio_xy.second * 2.0f - 1.0f;
-    float rw = ratio_wh.first * 2.0f;
-    float rh = ratio_wh.second * 2.0f;
-    float tw = (float)image.width  / (float)image.store_width;
-    float th = 1.0f - ((float)image.height / (float)image.store_height);
-
-    // float rx = -1.0f;
-    // float ry = -1.0f;
-    // float rw = 2.0f;
-    // float rh = 2.0f;
-    // float tw = 1.0f;
-    // float th = 1.0f;
+    float rx = float(top_left.first)  / float(window_size.first)  * 2.0f - 1.0f;
+    float ry = float(top_left.second) / float(window_size.second) * 2.0f - 1.0f;
+    float sx = 2.0f / float(window_size.first);
+    float sy = 2.0f / float(window_size.second);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    // There are 4 vertices in a rectangle, but we use 6 vertices in 2
-    // triangles to make the rectangle.
     // Each vertex has 2 floats for position, and 2 floats for texture
     // coordinates.
     // Format: vertex_x, vertex_y, texture_x, texture_y, ...
-    GLfloat vbo_data[] = {
-        // Triangle 1:
-        //     Bottom-left  (0, 0)
-        rx     , ry - rh, 0.0f, th  ,
-        //     Top-left     (0, 1)
-        rx     , ry     , 0.0f, 1.0f,
-        //     Top-right    (1, 1)
-        rx + rw, ry     , tw  , 1.0f,
-        // Triangle 2:
-        //     Bottom-left  (0, 0)
-        rx     , ry - rh, 0.0f, th  ,
-        //     Top-right    (1, 1)
-        rx + rw, ry     , tw  , 1.0f,
-        //     Bottom-right (1, 0)
-        rx + rw, ry - rh, tw  , th  ,
-    };
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vbo_data), vbo_data, GL_STATIC_DRAW);
+    std::vector<GLfloat> vbo_data(glyph_vertices);
+    for (size_t i = 0; i < vbo_data.size(); i += 4) {
+        vbo_data[i]     = rx + vbo_data[i]     * sx;
+        vbo_data[i + 1] = ry - vbo_data[i + 1] * sy;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vbo_data.size() * sizeof(GLfloat), vbo_data.data(), GL_STATIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    vbo_vertices = (GLsizei)(vbo_data.size() / 4);
     dirty_vbo = false;
 }
 
 
 void Text::set_text(std::string text) {
+    if (this->text != text) {
+        MapViewer::invalidate();
+    }
     this->text = text;
     dirty_texture = true;
 }
 
 
 std::pair<int,int> Text::get_rendered_size() {
-    // Needed to update image size.
+    // Needed to update the layout size.
     if (dirty_texture) {
         render();
     }
 
-    return std::make_pair(image.width, image.height);
+    return std::make_pair(rendered_width, rendered_height);
 }
 
 std::pair<float,float> Text::get_rendered_size_ratio() {
@@ -589,7 +485,7 @@ std::pair<float,float> Text::get_rendered_size_ratio() {
 
 
 std::pair<int,int> Text::get_text_size() {
-    // Needed to update image size.
+    // Needed to update the layout size.
     if (dirty_texture) {
         render();
     }
@@ -619,7 +515,7 @@ std::pair<float,float> Text::get_origin_ratio() {
 }
 
 std::pair<int,int> Text::get_top_left() {
-    // Needed to update image size.
+    // Needed to update the layout size.
     if (dirty_texture) {
         render();
     }
@@ -632,10 +528,10 @@ std::pair<int,int> Text::get_top_left() {
             x_final = x;
             break;
         case Alignment::CENTRE:
-            x_final = x - (image.width / 2);
+            x_final = x - (rendered_width / 2);
             break;
         case Alignment::RIGHT:
-            x_final = x - image.width;
+            x_final = x - rendered_width;
             break;
         }
     } else {
@@ -650,10 +546,10 @@ std::pair<int,int> Text::get_top_left() {
             y_final = y;
             break;
         case Alignment::CENTRE:
-            y_final = y + (image.height / 2);
+            y_final = y + (rendered_height / 2);
             break;
         case Alignment::BOTTOM:
-            y_final = y + image.height;
+            y_final = y + rendered_height;
             break;
         }
     } else {
@@ -720,11 +616,14 @@ void Text::align_at_origin(bool aao) {
 
 
 void Text::set_colour(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    // The colour is applied by the shader, so the layout stays valid.
+    if (rgba[0] != r || rgba[1] != g || rgba[2] != b || rgba[3] != a) {
+        MapViewer::invalidate();
+    }
     rgba[0] = r;
     rgba[1] = g;
     rgba[2] = b;
     rgba[3] = a;
-    dirty_texture = true;
 }
 
 
@@ -795,6 +694,18 @@ void Text::move_ratio(float x, float y) {
     }
 }
 
+void Text::prerender() {
+    window->use_context();
+    if (dirty_texture) {
+        try {
+            render();
+        }
+        catch (Text::RenderException e) {
+            LOG(WARNING) << e.what();
+        }
+    }
+}
+
 void Text::display() {
     window->use_context();
     if (dirty_texture) {
@@ -826,8 +737,17 @@ void Text::display() {
 
     std::shared_ptr<Shader> shader = shaders.find(window)->second;
     glUseProgram(shader->get_program());
+
+    // The distance field spans 2 * spread atlas pixels either side of
+    // the edge, so this blurs the edge over about one screen pixel.
+    float scale = float(font.size) / float(FontAtlas::base_size);
+    float smoothing = smooth ? 0.7f / (2.0f * float(FontAtlas::spread) * scale) : 0.0f;
+    glUniform4f(glGetUniformLocation(shader->get_program(), SHADER_VARIABLE_COLOUR),
+                float(rgba[0]) / 255.0f, float(rgba[1]) / 255.0f, float(rgba[2]) / 255.0f, float(rgba[3]) / 255.0f);
+    glUniform1f(glGetUniformLocation(shader->get_program(), SHADER_VARIABLE_SMOOTHING), smoothing);
+
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindTexture(GL_TEXTURE_2D, atlas->get_gl_texture());
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glDisable(GL_DEPTH_TEST);
 
@@ -841,7 +761,7 @@ void Text::display() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLES, 0, vbo_vertices);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
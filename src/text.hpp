@@ -3,20 +3,23 @@
 
 #include "open_gl.hpp"
 
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "text_font.hpp"
-#include "image.hpp"
 #include "callback.hpp"
 
+class FontAtlas;
 class GameWindow;
 
 
 
 ///
-/// Text (box) which uses an image as its display method.
+/// Text (box) which is drawn as glyph quads from its font's signed
+/// distance field atlas.
 ///
 /// Must be passed around by reference or pointer.
 ///
@@ -26,7 +29,7 @@ private:
         LEFT, RIGHT, TOP, BOTTOM, CENTRE
     };
     ///
-    /// If true, the text needs to be re-rendered.
+    /// If true, the text needs to be laid out again.
     ///
     bool dirty_texture;
     ///
@@ -113,13 +116,26 @@ private:
     ///
     bool ratio_position;
     ///
-    /// Image used to store the rendered text
+    /// The width of the displayed part of the text.
+    ///
+    int rendered_width;
+    ///
+    /// The height of the displayed part of the text, which is less
+    /// than used_height if the text overflows.
+    ///
+    int rendered_height;
     ///
-    Image image;
+    /// The glyph quads from the last layout.
     ///
-    /// Texture used in opengl.
+    /// Positions are in pixels from the top-left of the text, with y
+    /// increasing downwards. Each vertex is x, y, texture_x, texture_y.
     ///
-    GLuint texture;
+    std::vector<GLfloat> glyph_vertices;
+    ///
+    /// Signed distance field of the font, shared with all other text
+    /// using the same typeface.
+    ///
+    std::shared_ptr<FontAtlas> atlas;
     ///
     /// Vertex buffer object used in opengl.
     ///
@@ -128,6 +144,10 @@ private:
     ///
     GLuint vbo;
     ///
+    /// The number of vertices in the vbo.
+    ///
+    GLsizei vbo_vertices;
+    ///
     /// The colour to render the text as.
     ///
     uint8_t rgba[4];
@@ -145,15 +165,10 @@ private:
     Callback<void,GameWindow*> resize_callback;
 
     ///
-    /// Re-render the text.
+    /// Lay out the text into glyph quads.
     ///
     void render();
 
-    ///
-    /// Create an OpenGL texture from the image.
-    ///
-    void generate_texture();
-
     ///
     /// Creates text-specific vertex buffer object.
     ///
@@ -284,16 +299,14 @@ public:
     void set_colour(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 
     ///
-    /// Render the text to an image, and subsequently to an OpenGL
-    /// texture, give size information.
+    /// Set the size of the text area, which the text is wrapped to.
     ///
     /// Width and height are given in pixels. If a dimension is 0, then
     /// it is automatically sized.
     ///
     void resize(int w, int h);
     ///
-    /// Render the text to an image, and subsequently to an OpenGL
-    /// texture, give size information.
+    /// Set the size of the text area, which the text is wrapped to.
     ///
     /// Width and height are given in screen ratios. If a dimension is
     /// 0, then it is automatically sized.
@@ -310,6 +323,14 @@ public:
     ///
     void move_ratio(float x, float y);
     ///
+    /// Lay out the text now, rather than when it is first displayed.
+    ///
+    /// This lets text which is known in advance be prepared during idle
+    /// time, so displaying it later costs nothing extra. The text must
+    /// be sized first, or it will be rendered again when it is.
+    ///
+    void prerender();
+    ///
     /// Display the text.
     ///
     void display();
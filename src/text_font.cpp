@@ -1,12 +1,9 @@
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
 #include <glog/logging.h>
 
-extern "C" {
-#include "SDL2/SDL_ttf.h"
-}
-
 #include "text_font.hpp"
 #include "typeface.hpp"
 
@@ -17,19 +14,16 @@ TextFont::LoadException::LoadException(const char *message): std::runtime_error(
 TextFont::LoadException::LoadException(const std::string &message): std::runtime_error(message) {}
 
 
-TextFont::TextFont(Typeface face, int size) {
-    TTF_Font* font = TTF_OpenFont(face.filename.c_str(), size);
+TextFont::TextFont(Typeface face, int size):
+    filename(face.filename),
+    size(size) {
 
-    if (font == nullptr) {
-        LOG(ERROR) << "Unable to open font from file \"" << face.filename << "\" at size " << size << ": " << TTF_GetError();
+    // The atlas is loaded on first use, which needs a GL context, so
+    // report a missing file now rather than when the text is drawn.
+    if (!std::ifstream(filename) || size <= 0) {
+        LOG(ERROR) << "Unable to open font from file \"" << face.filename << "\" at size " << size;
         throw TextFont::LoadException("Unable to open font");
     }
-
-    this->font = font;
-
-    font_lifeline = Lifeline([font] () {
-            TTF_CloseFont(font);
-        });
 }
 
 TextFont::~TextFont() {
@@ -4,30 +4,27 @@
 #include <stdexcept>
 #include <string>
 
-extern "C" {
-#include <SDL2/SDL_ttf.h>
-}
-
-#include "lifeline.hpp"
-
 
 
 class Typeface;
 
 ///
-/// Wrapper for SDL_ttf font.
+/// A typeface at a size.
+///
+/// Fonts are drawn from the typeface's FontAtlas, which is shared by
+/// every size, so creating a font does not rasterise anything.
 ///
 class TextFont {
 private:
     friend class Text;
     ///
-    /// Destroy font when there are no more instances left.
+    /// Path to the ttf file, which names the FontAtlas.
     ///
-    Lifeline font_lifeline;
+    std::string filename;
     ///
-    /// Underlying SDL font.
+    /// Size of the font in pixels.
     ///
-    TTF_Font* font;
+    int size;
 public:
     ///
     /// Represents a failure in loading